@@ -7,6 +7,33 @@
 #include <vector>
 #include <array>
 #include <optional>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <new>
+#include <string>
+#include <string_view>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <queue>
+#include <charconv>
+#include <emmintrin.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // structure sources : https://community.bistudio.com/wiki/P3D_File_Format_-_MLOD
 
@@ -66,6 +93,218 @@ public:
 	std::uint64_t begin;
 };
 
+// read only memory mapping of a whole file
+class mapped_file
+{
+public:
+	explicit mapped_file(const std::string& path)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file, &file_size))
+			return;
+
+		size = static_cast<std::uint64_t>(file_size.QuadPart);
+		if (size == 0)
+		{
+			opened = true;
+			return;
+		}
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (mapping != nullptr)
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		fd = open(path.c_str(), O_RDONLY);
+
+		if (fd < 0)
+			return;
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0)
+			return;
+
+		size = static_cast<std::uint64_t>(info.st_size);
+		if (size == 0)
+		{
+			opened = true;
+			return;
+		}
+
+		auto* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (view != MAP_FAILED)
+		{
+			madvise(view, size, MADV_SEQUENTIAL);
+			data = static_cast<const char*>(view);
+		}
+#endif
+		opened = data != nullptr;
+	}
+
+	~mapped_file()
+	{
+#ifdef _WIN32
+		if (data != nullptr)
+			UnmapViewOfFile(data);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+#else
+		if (data != nullptr)
+			munmap(const_cast<char*>(data), size);
+		if (fd >= 0)
+			close(fd);
+#endif
+	}
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	// empty files open without a mapping
+	bool opened{};
+	const char* data{};
+	std::uint64_t size{};
+
+private:
+#ifdef _WIN32
+	HANDLE file{ INVALID_HANDLE_VALUE };
+	HANDLE mapping{};
+#else
+	int fd{ -1 };
+#endif
+};
+
+// set while a thread runs a chunk of a parallel_for, nested calls then run inline
+// rather than starting hardware_concurrency threads from every worker
+inline thread_local bool in_parallel_region = false;
+
+// runs fn(begin, end) over [0, count) split into one chunk per hardware thread,
+// never making chunks smaller than min_chunk
+template<typename Fn>
+void parallel_for(const std::size_t count, const std::size_t min_chunk, Fn&& fn)
+{
+	const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+	const auto chunks = in_parallel_region ? 1 : std::min(hw, (count + min_chunk - 1) / std::max<std::size_t>(min_chunk, 1));
+
+	if (chunks <= 1)
+	{
+		if (count != 0)
+			fn(std::size_t{ 0 }, count);
+		return;
+	}
+
+	const auto step = (count + chunks - 1) / chunks;
+	std::vector<std::thread> threads;
+	threads.reserve(chunks - 1);
+
+	for (auto begin = step; begin < count; begin += step)
+	{
+		threads.emplace_back([&fn, begin, end = std::min(begin + step, count)]()
+		{
+			in_parallel_region = true;
+			fn(begin, end);
+		});
+	}
+
+	in_parallel_region = true;
+	fn(std::size_t{ 0 }, std::min(step, count));
+	in_parallel_region = false;
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+// sorts chunks on every hardware thread, then merges neighbouring runs pairwise in parallel
+template<typename It, typename Compare>
+void parallel_sort(It first, It last, Compare comp, const std::size_t min_chunk = 65536)
+{
+	const auto count = static_cast<std::size_t>(last - first);
+	const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+	const auto chunks = in_parallel_region ? 1 : std::min(hw, count / std::max<std::size_t>(min_chunk, 1));
+
+	if (chunks <= 1)
+	{
+		std::sort(first, last, comp);
+		return;
+	}
+
+	const auto step = (count + chunks - 1) / chunks;
+	std::vector<std::size_t> bounds;
+
+	for (std::size_t begin = 0; begin < count; begin += step)
+		bounds.push_back(begin);
+	bounds.push_back(count);
+
+	parallel_for(bounds.size() - 1, 1, [&](const std::size_t begin, const std::size_t end)
+	{
+		for (auto i = begin; i < end; i++)
+			std::sort(first + bounds[i], first + bounds[i + 1], comp);
+	});
+
+	while (bounds.size() > 2)
+	{
+		const auto runs = bounds.size() - 1;
+
+		parallel_for(runs / 2, 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				std::inplace_merge(first + bounds[i * 2], first + bounds[i * 2 + 1], first + bounds[i * 2 + 2], comp);
+		});
+
+		std::vector<std::size_t> merged;
+
+		for (std::size_t i = 0; i < bounds.size(); i += 2)
+			merged.push_back(bounds[i]);
+
+		if (merged.back() != count)
+			merged.push_back(count);
+
+		bounds = std::move(merged);
+	}
+}
+
+// allocator for the SoA arrays fed to the SSE kernels
+template<typename T, std::size_t Alignment = 16>
+struct aligned_allocator
+{
+	using value_type = T;
+
+	template<typename U>
+	struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+	aligned_allocator() = default;
+
+	template<typename U>
+	aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+	T* allocate(const std::size_t n)
+	{
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	void deallocate(T* p, std::size_t)
+	{
+		::operator delete(p, std::align_val_t(Alignment));
+	}
+
+	template<typename U>
+	bool operator==(const aligned_allocator<U, Alignment>&) const { return true; }
+
+	template<typename U>
+	bool operator!=(const aligned_allocator<U, Alignment>&) const { return false; }
+};
+
+template<typename T>
+using aligned_vector = std::vector<T, aligned_allocator<T>>;
+
 #pragma pack(push, 1)
 struct vector3
 {
@@ -203,7 +442,12 @@ struct mlod_face
 		arma_string::write(writer, in.texture_name);
 		arma_string::write(writer, in.material_name);
 	}
-	
+
+	// vertices always holds 4 descriptors, only the first face_type are used
+	std::uint32_t corner_count() const
+	{
+		return face_type >= 4 ? 4 : 3;
+	}
 };
 
 struct mlod_point
@@ -272,257 +516,7939 @@ struct mlod_tag
 	}
 };
 
+// decoded form of one raw tag in mlod_lod::tags. the decoded value is the source
+// of truth, it's re-encoded by mlod_lod::write only when it was touched through edit()
+template<typename T>
+struct typed_tag
+{
+	static constexpr std::size_t detached = ~std::size_t{ 0 };
+
+	// raw tag this replaces, detached tags are emitted right before #EndOfFile#
+	std::size_t tag_index{ detached };
+	bool dirty{};
+	T value{};
+
+	const T& get() const { return value; }
+	const T* operator->() const { return &value; }
+
+	T& edit()
+	{
+		dirty = true;
+		return value;
+	}
+
+	mlod_tag encode() const
+	{
+		binary_writer writer;
+		T::write(writer, value);
+
+		mlod_tag out{};
+		out.active = true;
+		out.tag_name.string = T::name;
+		out.data = std::move(writer.data);
+		out.data_length = static_cast<std::uint32_t>(out.data.size());
+		return out;
+	}
+};
+
 struct property_tag
 {
+	static constexpr const char* name = "#Property#";
+
+	// trimmed at the first NUL
 	std::string key{};
 	std::string value{};
 
+	// the fixed size fields as stored, re-emitted as long as key/value still match them
+	std::array<char, 64> raw_key{};
+	std::array<char, 64> raw_value{};
+
 	property_tag() = default;
+
+	property_tag(std::string property_key, std::string property_value)
+		: key(std::move(property_key)), value(std::move(property_value)) {}
 	
 	explicit property_tag(const mlod_tag& parent_tag)
 	{
 		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
-		key.resize(64);
-		value.resize(64);
 
-		for(auto& ch : key)
+		for(auto& ch : raw_key)
 		{
 			reader.read(ch);
 		}
 
-		for (auto& ch : value)
+		for (auto& ch : raw_value)
 		{
 			reader.read(ch);
 		}
 
+		key = trim(raw_key);
+		value = trim(raw_value);
 	}
-};
 
-struct mass_tag
-{
-	std::vector<float> mass;
-	
-	mass_tag() = default;
+	static std::string trim(const std::array<char, 64>& field)
+	{
+		return std::string(field.data(), std::find(field.begin(), field.end(), '\0') - field.begin());
+	}
 
-	explicit mass_tag(const mlod_tag& parent_tag, const std::uint32_t num_points)
+	static void write_field(binary_writer& writer, const std::string& str, const std::array<char, 64>& raw)
 	{
-		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
-		mass.resize(num_points);
-		
-		for (auto& m : mass)
+		if (str == trim(raw))
 		{
-			reader.read(m);
+			for (const auto ch : raw)
+				writer.write(ch);
+			return;
 		}
+
+		// always leave room for the terminator
+		for (std::size_t i = 0; i < 64; i++)
+			writer.write(i < std::min<std::size_t>(str.size(), 63) ? str[i] : '\0');
+	}
+
+	static void write(binary_writer& writer, const property_tag& in)
+	{
+		write_field(writer, in.key, in.raw_key);
+		write_field(writer, in.value, in.raw_value);
 	}
 };
 
-struct mlod_lod
+// a lod's #Property# tags in file order, indexed by an open addressing table
+// over their case folded keys. duplicate keys resolve to the first one. entries
+// are read only outside of set() so keys can't drift from the table
+struct property_map
 {
-	mlod_signature signature{};
-	std::uint32_t minor_version{};
-	std::uint32_t major_version{};
-	std::uint32_t num_points{};
-	std::uint32_t num_face_normals{};
-	std::uint32_t num_faces{};
-	std::uint32_t flags{};
-	std::vector<mlod_point> points;
-	std::vector<vector3> normals;
-	std::vector<mlod_face> faces;
-	mlod_signature tag_sig{};
-	std::vector<mlod_tag> tags;
-	float resolution{};
+	static constexpr std::uint32_t empty_slot = ~std::uint32_t{ 0 };
 
-	// converted tags
-	std::vector<property_tag> property_tags;
-	mass_tag mass;
+	// longest key or value that fits a 64 byte field with its terminator
+	static constexpr std::size_t max_length = 63;
 
-	static std::optional<mlod_error> parse(binary_reader& reader, mlod_lod& out)
+	static char fold(const char ch)
 	{
-		if (!reader.read(out.signature))
-			return mlod_error("failed to read mlod_lod.signature");
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+	}
 
-		if (!reader.read(out.minor_version))
-			return mlod_error("failed to read mlod_lod.minor_version");
+	static std::uint32_t hash(const std::string_view key)
+	{
+		std::uint32_t h = 2166136261u;
 
-		if (!reader.read(out.major_version))
-			return mlod_error("failed to read mlod_lod.major_version");
+		for (const auto ch : key)
+		{
+			h ^= static_cast<unsigned char>(fold(ch));
+			h *= 16777619u;
+		}
 
-		if (!reader.read(out.num_points))
-			return mlod_error("failed to read mlod_lod.num_points");
+		return h;
+	}
 
-		if (!reader.read(out.num_face_normals))
-			return mlod_error("failed to read mlod_lod.num_face_normals");
-		
-		if (!reader.read(out.num_faces))
-			return mlod_error("failed to read mlod_lod.num_faces");
+	static bool equals(const std::string_view l, const std::string_view r)
+	{
+		if (l.size() != r.size())
+			return false;
 
-		if (!reader.read(out.flags))
-			return mlod_error("failed to read mlod_lod.flags");
-		
-		out.points.resize(out.num_points);
-		
-		for(auto& point : out.points)
+		for (std::size_t i = 0; i < l.size(); i++)
 		{
-			auto err = mlod_point::parse(reader, point);
-
-			if (err.has_value()) 
-				return err;
+			if (fold(l[i]) != fold(r[i]))
+				return false;
 		}
 
-		out.normals.resize(out.num_face_normals);
+		return true;
+	}
 
-		for(auto& normal : out.normals)
-		{
-			auto err = vector3::parse(reader, normal);
-			
-			if (err.has_value()) 
-				return err;
-		}
+	std::uint32_t find_index(const std::string_view key) const
+	{
+		if (slots.empty())
+			return empty_slot;
 
-		out.faces.resize(out.num_faces);
+		const auto mask = static_cast<std::uint32_t>(slots.size() - 1);
 
-		for(auto& face : out.faces)
+		for (auto slot = hash(key) & mask;; slot = (slot + 1) & mask)
 		{
-			auto err = mlod_face::parse(reader, face);
-			
-			if (err.has_value()) 
-				return err;
+			if (slots[slot] == empty_slot)
+				return empty_slot;
+
+			if (equals(items[slots[slot]]->key, key))
+				return slots[slot];
 		}
+	}
 
-		if (!reader.read(out.tag_sig))
-			return mlod_error("failed to read mlod_lod.tag_sig");
-		
-		do
-		{
-			mlod_tag tag{};
-			
-			auto err = mlod_tag::parse(reader, tag);
+	const std::vector<typed_tag<property_tag>>& entries() const
+	{
+		return items;
+	}
 
-			if (err.has_value())
-				return err;
+	const property_tag* find(const std::string_view key) const
+	{
+		const auto index = find_index(key);
+		return index == empty_slot ? nullptr : &items[index].get();
+	}
 
-			out.tags.push_back(tag);
+	// empty when the property doesn't exist
+	std::string_view value(const std::string_view key) const
+	{
+		const auto* property = find(key);
+		return property ? std::string_view(property->value) : std::string_view{};
+	}
 
-			if(tag.tag_name.string == "#Property#")
-			{
-				out.property_tags.emplace_back(tag);
-			}
-			else if (tag.tag_name.string == "#Mass#")
-			{
-				out.mass = mass_tag(tag, out.num_points);
-			}
-			
-			if (tag.tag_name.string == "#EndOfFile#") break;
-			
-		} while (true);
+	// overwrites an existing property or appends a new #Property# tag. keys and
+	// values that wouldn't fit the fixed size fields are rejected
+	std::optional<mlod_error> set(const std::string_view key, std::string value)
+	{
+		if (key.empty() || key.size() > max_length)
+			return mlod_error(fmt::format("property_map: key '{}' must be 1 to {} characters", key, max_length));
 
-		if (!reader.read(out.resolution))
-			return mlod_error("failed to read mlod_lod.resolution");
+		if (value.size() > max_length)
+			return mlod_error(fmt::format("property_map: value of '{}' is longer than {} characters", key, max_length));
+
+		const auto index = find_index(key);
 
+		if (index != empty_slot)
+		{
+			items[index].edit().value = std::move(value);
+			return {};
+		}
+
+		add({ typed_tag<property_tag>::detached, true, property_tag(std::string(key), std::move(value)) });
 		return {};
 	}
 
-	static void write(binary_writer& writer, const mlod_lod& in)
-	{
-		writer.write(in.signature);
-		writer.write(in.minor_version);
-		writer.write(in.major_version);
-		writer.write(in.num_points);
-		writer.write(in.num_face_normals);
-		writer.write(in.num_faces);
-		writer.write(in.flags);
+private:
+	friend struct mlod_lod;
 
-		for (const auto& point : in.points)
-		{
-			mlod_point::write(writer, point);
-		}
+	std::vector<typed_tag<property_tag>> items;
+	std::vector<std::uint32_t> slots;
 
-		for (const auto& normal : in.normals)
-		{
-			vector3::write(writer, normal);
-		}
+	// adds an entry decoded from mlod_lod::tags or through set()
+	void add(typed_tag<property_tag> entry)
+	{
+		items.push_back(std::move(entry));
 
-		for (const auto& face : in.faces)
-		{
-			mlod_face::write(writer, face);
-		}
+		if (items.size() * 2 > slots.size())
+			rehash(std::max<std::size_t>(16, slots.size() * 2));
+		else
+			index(static_cast<std::uint32_t>(items.size() - 1));
+	}
 
-		writer.write(in.tag_sig);
+	void index(const std::uint32_t entry)
+	{
+		const auto mask = static_cast<std::uint32_t>(slots.size() - 1);
 
-		for(const auto& tag : in.tags)
+		for (auto slot = hash(items[entry]->key) & mask;; slot = (slot + 1) & mask)
 		{
-			mlod_tag::write(writer, tag);
+			if (slots[slot] == empty_slot)
+			{
+				slots[slot] = entry;
+				return;
+			}
+
+			// keep the first of duplicate keys
+			if (equals(items[slots[slot]]->key, items[entry]->key))
+				return;
 		}
+	}
 
-		writer.write(in.resolution);
+	void rehash(const std::size_t capacity)
+	{
+		slots.assign(capacity, empty_slot);
+
+		for (std::uint32_t i = 0; i < items.size(); i++)
+			index(i);
 	}
 };
 
-struct p3d_header
+struct mass_tag
 {
-	mlod_signature signature{};
-	std::uint32_t version{};
-	std::uint32_t lod_count{};
+	static constexpr const char* name = "#Mass#";
 
+	std::vector<float> mass;
+	
+	mass_tag() = default;
 
-	static std::optional<mlod_error> parse(binary_reader& reader, p3d_header& out)
+	explicit mass_tag(const mlod_tag& parent_tag, const std::uint32_t num_points)
 	{
-		if(!reader.read<mlod_signature>(out.signature))
-			return mlod_error("failed to read p3d_header.signature");
-
+		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
+		mass.resize(num_points);
+		
+		for (auto& m : mass)
+		{
+			reader.read(m);
+		}
+	}
+
+	static void write(binary_writer& writer, const mass_tag& in)
+	{
+		for (const auto m : in.mass)
+			writer.write(m);
+	}
+};
+
+// #SharpEdges# tag, pairs of point indices. the pairs are kept as stored for
+// re-encoding and mirrored in an open addressing set for O(1) lookups
+struct sharp_edges_tag
+{
+	static constexpr const char* name = "#SharpEdges#";
+
+	static constexpr std::uint64_t empty_slot = ~std::uint64_t{ 0 };
+
+	sharp_edges_tag() = default;
+
+	explicit sharp_edges_tag(const mlod_tag& parent_tag)
+	{
+		append(parent_tag);
+	}
+
+	// lods can carry several #SharpEdges# tags, their edges add up
+	void append(const mlod_tag& parent_tag)
+	{
+		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
+		pairs.reserve(pairs.size() + parent_tag.data.size() / 8);
+
+		std::array<std::uint32_t, 2> edge{};
+
+		// duplicates and degenerate pairs are kept so re-encoding is lossless
+		while (reader.read(edge[0]) && reader.read(edge[1]))
+		{
+			pairs.push_back(edge);
+			add(edge[0], edge[1]);
+		}
+	}
+
+	// order independent, the lower index always lands in the low half
+	static std::uint64_t key(const std::uint32_t a, const std::uint32_t b)
+	{
+		return a < b
+			? (static_cast<std::uint64_t>(b) << 32) | a
+			: (static_cast<std::uint64_t>(a) << 32) | b;
+	}
+
+	static std::size_t hash(std::uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdull;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ull;
+		k ^= k >> 33;
+		return static_cast<std::size_t>(k);
+	}
+
+	bool contains(const std::uint64_t k) const
+	{
+		if (slots.empty())
+			return false;
+
+		const auto mask = slots.size() - 1;
+
+		for (auto slot = hash(k) & mask;; slot = (slot + 1) & mask)
+		{
+			if (slots[slot] == k)
+				return true;
+
+			if (slots[slot] == empty_slot)
+				return false;
+		}
+	}
+
+	bool contains(const std::uint32_t a, const std::uint32_t b) const
+	{
+		return contains(key(a, b));
+	}
+
+	// returns false if the edge was already present or is degenerate
+	bool insert(const std::uint32_t a, const std::uint32_t b)
+	{
+		if (!add(a, b))
+			return false;
+
+		pairs.push_back({ a, b });
+		return true;
+	}
+
+	// pairs in file order, append() and insert() are the only ways in so the
+	// lookup table always matches them
+	const std::vector<std::array<std::uint32_t, 2>>& edges() const
+	{
+		return pairs;
+	}
+
+	static void write(binary_writer& writer, const sharp_edges_tag& in)
+	{
+		for (const auto& edge : in.pairs)
+		{
+			writer.write(edge[0]);
+			writer.write(edge[1]);
+		}
+	}
+
+private:
+	std::vector<std::array<std::uint32_t, 2>> pairs;
+	std::vector<std::uint64_t> slots;
+	std::uint32_t count{};
+
+	// indexes a pair without recording it
+	bool add(const std::uint32_t a, const std::uint32_t b)
+	{
+		if (a == b)
+			return false;
+
+		if ((count + 1) * 2 > slots.size())
+			rehash(std::max<std::size_t>(16, slots.size() * 2));
+
+		const auto k = key(a, b);
+		const auto mask = slots.size() - 1;
+
+		for (auto slot = hash(k) & mask;; slot = (slot + 1) & mask)
+		{
+			if (slots[slot] == k)
+				return false;
+
+			if (slots[slot] == empty_slot)
+			{
+				slots[slot] = k;
+				count++;
+				return true;
+			}
+		}
+	}
+
+	void rehash(const std::size_t capacity)
+	{
+		std::vector<std::uint64_t> old(capacity, empty_slot);
+		old.swap(slots);
+
+		const auto mask = slots.size() - 1;
+
+		for (const auto k : old)
+		{
+			if (k == empty_slot)
+				continue;
+
+			auto slot = hash(k) & mask;
+			while (slots[slot] != empty_slot)
+				slot = (slot + 1) & mask;
+
+			slots[slot] = k;
+		}
+	}
+};
+
+// #UVSet# tag, a stage id followed by one u/v pair per used face corner,
+// decoded into flat per corner SoA channels
+struct uv_set_tag
+{
+	static constexpr const char* name = "#UVSet#";
+
+	std::uint32_t stage_id{};
+	aligned_vector<float> u;
+	aligned_vector<float> v;
+	std::vector<std::uint8_t> trailing;
+	// false for payloads too short to hold the stage id, trailing then holds all of it
+	bool has_stage_id{ true };
+
+	uv_set_tag() = default;
+
+	explicit uv_set_tag(const mlod_tag& parent_tag)
+	{
+		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
+
+		if (!reader.read(stage_id))
+		{
+			has_stage_id = false;
+			trailing = parent_tag.data;
+			return;
+		}
+
+		const auto corners = (parent_tag.data.size() - 4) / 8;
+		u.resize(corners);
+		v.resize(corners);
+
+		for (std::size_t i = 0; i < corners; i++)
+		{
+			reader.read(u[i]);
+			reader.read(v[i]);
+		}
+
+		// anything that doesn't form a full pair, kept for re-encoding
+		trailing.assign(parent_tag.data.begin() + static_cast<std::ptrdiff_t>(reader.current_offset), parent_tag.data.end());
+	}
+
+	// offset of every face's first corner into u/v, with the total as last element
+	static std::vector<std::uint32_t> corner_offsets(const std::vector<mlod_face>& faces)
+	{
+		std::vector<std::uint32_t> offsets(faces.size() + 1);
+
+		for (std::size_t f = 0; f < faces.size(); f++)
+			offsets[f + 1] = offsets[f] + faces[f].corner_count();
+
+		return offsets;
+	}
+
+	bool matches(const std::vector<mlod_face>& faces) const
+	{
+		return corner_offsets(faces).back() == u.size();
+	}
+
+	static void write(binary_writer& writer, const uv_set_tag& in)
+	{
+		if (in.has_stage_id)
+			writer.write(in.stage_id);
+
+		for (std::size_t i = 0; i < in.u.size(); i++)
+		{
+			writer.write(in.u[i]);
+			writer.write(in.v[i]);
+		}
+
+		for (const auto b : in.trailing)
+			writer.write(b);
+	}
+};
+
+// #Animation# tag, a frame time followed by a position for every point
+struct animation_tag
+{
+	static constexpr const char* name = "#Animation#";
+
+	float time{};
+	aligned_vector<float> x;
+	aligned_vector<float> y;
+	aligned_vector<float> z;
+	std::vector<std::uint8_t> trailing;
+	// false for frames too short to hold every point, x/y/z are then left empty and
+	// trailing holds the whole payload so it's written back as read
+	bool complete{ true };
+
+	animation_tag() = default;
+
+	explicit animation_tag(const mlod_tag& parent_tag, const std::uint32_t num_points)
+	{
+		binary_reader reader(parent_tag.data.data(), parent_tag.data.size());
+		reader.read(time);
+
+		if (parent_tag.data.size() < sizeof(float) + std::size_t{ num_points } * 12)
+		{
+			complete = false;
+			trailing = parent_tag.data;
+			return;
+		}
+
+		x.resize(num_points);
+		y.resize(num_points);
+		z.resize(num_points);
+
+		for (std::uint32_t i = 0; i < num_points; i++)
+		{
+			reader.read(x[i]);
+			reader.read(y[i]);
+			reader.read(z[i]);
+		}
+
+		if (reader.current_offset < parent_tag.data.size())
+			trailing.assign(parent_tag.data.begin() + static_cast<std::ptrdiff_t>(reader.current_offset), parent_tag.data.end());
+	}
+
+	static void write(binary_writer& writer, const animation_tag& in)
+	{
+		if (in.complete)
+			writer.write(in.time);
+
+		for (std::size_t i = 0; i < in.x.size(); i++)
+		{
+			writer.write(in.x[i]);
+			writer.write(in.y[i]);
+			writer.write(in.z[i]);
+		}
+
+		for (const auto b : in.trailing)
+			writer.write(b);
+	}
+};
+
+struct mlod_lod
+{
+	mlod_signature signature{};
+	std::uint32_t minor_version{};
+	std::uint32_t major_version{};
+	std::uint32_t num_points{};
+	std::uint32_t num_face_normals{};
+	std::uint32_t num_faces{};
+	std::uint32_t flags{};
+	std::vector<mlod_point> points;
+	std::vector<vector3> normals;
+	std::vector<mlod_face> faces;
+	mlod_signature tag_sig{};
+	std::vector<mlod_tag> tags;
+	float resolution{};
+
+	// converted tags
+	property_map properties;
+	typed_tag<mass_tag> mass;
+	typed_tag<sharp_edges_tag> sharp_edges;
+	std::vector<typed_tag<uv_set_tag>> uv_sets;
+	std::vector<typed_tag<animation_tag>> animations;
+
+	// Self is mlod_lod or const mlod_lod
+	template<typename Self, typename Fn>
+	static void for_each_typed_tag(Self& lod, Fn&& fn)
+	{
+		for (auto& tag : lod.properties.items)
+			fn(tag);
+
+		fn(lod.mass);
+		fn(lod.sharp_edges);
+
+		for (auto& tag : lod.uv_sets)
+			fn(tag);
+
+		for (auto& tag : lod.animations)
+			fn(tag);
+	}
+
+	// raw tags added after parsing go right before #EndOfFile#
+	void add_tag(mlod_tag tag)
+	{
+		auto pos = tags.size();
+
+		if (!tags.empty() && tags.back().tag_name.string == "#EndOfFile#")
+			pos--;
+
+		for_each_typed_tag(*this, [pos](auto& typed)
+		{
+			if (typed.tag_index != typed.detached && typed.tag_index >= pos)
+				typed.tag_index++;
+		});
+
+		tags.insert(tags.begin() + static_cast<std::ptrdiff_t>(pos), std::move(tag));
+	}
+
+	// drops raw tags matching pred, typed tags decoded from them are detached
+	template<typename Pred>
+	void remove_tags(Pred&& pred)
+	{
+		constexpr auto removed = ~std::size_t{ 0 };
+		std::vector<std::size_t> index_map(tags.size(), removed);
+		std::vector<mlod_tag> kept;
+
+		for (std::size_t i = 0; i < tags.size(); i++)
+		{
+			if (pred(static_cast<const mlod_tag&>(tags[i])))
+				continue;
+
+			index_map[i] = kept.size();
+			kept.push_back(std::move(tags[i]));
+		}
+
+		for_each_typed_tag(*this, [&index_map](auto& typed)
+		{
+			if (typed.tag_index < index_map.size())
+				typed.tag_index = index_map[typed.tag_index];
+		});
+
+		tags = std::move(kept);
+	}
+
+	static std::optional<mlod_error> parse(binary_reader& reader, mlod_lod& out)
+	{
+		if (!reader.read(out.signature))
+			return mlod_error("failed to read mlod_lod.signature");
+
+		if (!reader.read(out.minor_version))
+			return mlod_error("failed to read mlod_lod.minor_version");
+
+		if (!reader.read(out.major_version))
+			return mlod_error("failed to read mlod_lod.major_version");
+
+		if (!reader.read(out.num_points))
+			return mlod_error("failed to read mlod_lod.num_points");
+
+		if (!reader.read(out.num_face_normals))
+			return mlod_error("failed to read mlod_lod.num_face_normals");
+		
+		if (!reader.read(out.num_faces))
+			return mlod_error("failed to read mlod_lod.num_faces");
+
+		if (!reader.read(out.flags))
+			return mlod_error("failed to read mlod_lod.flags");
+		
+		out.points.resize(out.num_points);
+		
+		for(auto& point : out.points)
+		{
+			auto err = mlod_point::parse(reader, point);
+
+			if (err.has_value()) 
+				return err;
+		}
+
+		out.normals.resize(out.num_face_normals);
+
+		for(auto& normal : out.normals)
+		{
+			auto err = vector3::parse(reader, normal);
+			
+			if (err.has_value()) 
+				return err;
+		}
+
+		out.faces.resize(out.num_faces);
+
+		for(auto& face : out.faces)
+		{
+			auto err = mlod_face::parse(reader, face);
+			
+			if (err.has_value()) 
+				return err;
+		}
+
+		if (!reader.read(out.tag_sig))
+			return mlod_error("failed to read mlod_lod.tag_sig");
+		
+		do
+		{
+			mlod_tag tag{};
+			
+			auto err = mlod_tag::parse(reader, tag);
+
+			if (err.has_value())
+				return err;
+
+			const auto index = out.tags.size();
+			out.tags.push_back(tag);
+
+			if(tag.tag_name.string == "#Property#")
+			{
+				out.properties.add({ index, false, property_tag(tag) });
+			}
+			else if (tag.tag_name.string == "#Mass#")
+			{
+				out.mass = { index, false, mass_tag(tag, out.num_points) };
+			}
+			else if (tag.tag_name.string == "#SharpEdges#")
+			{
+				// later tags are merged into the one decoded from the first
+				if (out.sharp_edges.tag_index == out.sharp_edges.detached)
+					out.sharp_edges = { index, false, sharp_edges_tag(tag) };
+				else
+					out.sharp_edges.value.append(tag);
+			}
+			else if (tag.tag_name.string == "#UVSet#")
+			{
+				out.uv_sets.push_back({ index, false, uv_set_tag(tag) });
+			}
+			else if (tag.tag_name.string == "#Animation#")
+			{
+				out.animations.push_back({ index, false, animation_tag(tag, out.num_points) });
+			}
+			
+			if (tag.tag_name.string == "#EndOfFile#") break;
+			
+		} while (true);
+
+		if (!reader.read(out.resolution))
+			return mlod_error("failed to read mlod_lod.resolution");
+
+		return {};
+	}
+
+	// an empty lod laid out like one Object Builder saves
+	static mlod_lod create(const float resolution)
+	{
+		mlod_lod out;
+		out.signature = { 'P', '3', 'D', 'M' };
+		// file order, the 0x1c version comes first
+		out.minor_version = 0x1c;
+		out.major_version = 0x100;
+		out.tag_sig = { 'T', 'A', 'G', 'G' };
+		out.resolution = resolution;
+
+		mlod_tag end{};
+		end.active = true;
+		end.tag_name.string = "#EndOfFile#";
+		out.tags.push_back(std::move(end));
+
+		return out;
+	}
+
+	static void write(binary_writer& writer, const mlod_lod& in)
+	{
+		writer.write(in.signature);
+		writer.write(in.minor_version);
+		writer.write(in.major_version);
+		writer.write(in.num_points);
+		writer.write(in.num_face_normals);
+		writer.write(in.num_faces);
+		writer.write(in.flags);
+
+		for (const auto& point : in.points)
+		{
+			mlod_point::write(writer, point);
+		}
+
+		for (const auto& normal : in.normals)
+		{
+			vector3::write(writer, normal);
+		}
+
+		for (const auto& face : in.faces)
+		{
+			mlod_face::write(writer, face);
+		}
+
+		writer.write(in.tag_sig);
+
+		// dirty typed tags are re-encoded in place of the raw tag they came from
+		std::vector<const mlod_tag*> replaced(in.tags.size());
+		std::vector<mlod_tag> encoded;
+		std::vector<mlod_tag> appended;
+
+		encoded.reserve(in.tags.size());
+
+		for_each_typed_tag(in, [&](const auto& typed)
+		{
+			if (!typed.dirty)
+				return;
+
+			if (typed.tag_index < in.tags.size())
+			{
+				encoded.push_back(typed.encode());
+				encoded.back().active = in.tags[typed.tag_index].active;
+				replaced[typed.tag_index] = &encoded.back();
+			}
+			else
+			{
+				appended.push_back(typed.encode());
+			}
+		});
+
+		for (std::size_t i = 0; i < in.tags.size(); i++)
+		{
+			if (in.tags[i].tag_name.string == "#EndOfFile#")
+			{
+				for (const auto& tag : appended)
+					mlod_tag::write(writer, tag);
+			}
+
+			// a re-encoded sharp_edges holds the edges of every #SharpEdges# tag
+			if (in.sharp_edges.dirty && i != in.sharp_edges.tag_index && in.tags[i].tag_name.string == sharp_edges_tag::name)
+				continue;
+
+			mlod_tag::write(writer, replaced[i] ? *replaced[i] : in.tags[i]);
+		}
+
+		writer.write(in.resolution);
+	}
+};
+
+struct p3d_header
+{
+	mlod_signature signature{};
+	std::uint32_t version{};
+	std::uint32_t lod_count{};
+
+
+	static std::optional<mlod_error> parse(binary_reader& reader, p3d_header& out)
+	{
+		if(!reader.read<mlod_signature>(out.signature))
+			return mlod_error("failed to read p3d_header.signature");
+
 		if (!reader.read<std::uint32_t>(out.version))
 			return mlod_error("failed to read p3d_header.version");
 
-		if (!reader.read<std::uint32_t>(out.lod_count))
-			return mlod_error("failed to read p3d_header.lod_count");
-		
+		if (!reader.read<std::uint32_t>(out.lod_count))
+			return mlod_error("failed to read p3d_header.lod_count");
+		
+		return {};
+	}
+
+	static void write(binary_writer& writer, const p3d_header& in)
+	{
+		writer.write(in.signature);
+		writer.write(in.version);
+		writer.write(in.lod_count);
+	}
+};
+
+enum class lod_kind : std::uint8_t
+{
+	visual,
+	view_gunner,
+	view_pilot,
+	view_cargo,
+	shadow_volume,
+	edit,
+	geometry,
+	geometry_buoyancy,
+	geometry_physx_old,
+	geometry_physx,
+	memory,
+	land_contact,
+	roadway,
+	paths,
+	hit_points,
+	view_geometry,
+	fire_geometry,
+	view_cargo_geometry,
+	view_cargo_fire_geometry,
+	view_commander,
+	view_commander_geometry,
+	view_commander_fire_geometry,
+	view_pilot_geometry,
+	view_pilot_fire_geometry,
+	view_gunner_geometry,
+	view_gunner_fire_geometry,
+	sub_parts,
+	shadow_volume_view_cargo,
+	shadow_volume_view_pilot,
+	shadow_volume_view_gunner,
+	wreck,
+	unknown,
+	count,
+};
+
+// special resolutions are exact values (min == max), the rest are ranges [min, max)
+struct lod_class
+{
+	float min;
+	float max;
+	lod_kind kind;
+	const char* name;
+};
+
+// sorted by min
+constexpr lod_class lod_classes[] = {
+	{ 0.0f, 1e3f, lod_kind::visual, "Visual" },
+	{ 1e3f, 1e3f, lod_kind::view_gunner, "View Gunner" },
+	{ 1.1e3f, 1.1e3f, lod_kind::view_pilot, "View Pilot" },
+	{ 1.2e3f, 1.2e3f, lod_kind::view_cargo, "View Cargo" },
+	{ 1e4f, 2e4f, lod_kind::shadow_volume, "Shadow Volume" },
+	{ 2e4f, 3e4f, lod_kind::edit, "Edit" },
+	{ 1e13f, 1e13f, lod_kind::geometry, "Geometry" },
+	{ 2e13f, 2e13f, lod_kind::geometry_buoyancy, "Geometry Buoyancy" },
+	{ 3e13f, 3e13f, lod_kind::geometry_physx_old, "Geometry PhysX Old" },
+	{ 4e13f, 4e13f, lod_kind::geometry_physx, "Geometry PhysX" },
+	{ 1e15f, 1e15f, lod_kind::memory, "Memory" },
+	{ 2e15f, 2e15f, lod_kind::land_contact, "Land Contact" },
+	{ 3e15f, 3e15f, lod_kind::roadway, "Roadway" },
+	{ 4e15f, 4e15f, lod_kind::paths, "Paths" },
+	{ 5e15f, 5e15f, lod_kind::hit_points, "Hit-points" },
+	{ 6e15f, 6e15f, lod_kind::view_geometry, "View Geometry" },
+	{ 7e15f, 7e15f, lod_kind::fire_geometry, "Fire Geometry" },
+	{ 8e15f, 8e15f, lod_kind::view_cargo_geometry, "View Cargo Geometry" },
+	{ 9e15f, 9e15f, lod_kind::view_cargo_fire_geometry, "View Cargo Fire Geometry" },
+	{ 1e16f, 1e16f, lod_kind::view_commander, "View Commander" },
+	{ 1.1e16f, 1.1e16f, lod_kind::view_commander_geometry, "View Commander Geometry" },
+	{ 1.2e16f, 1.2e16f, lod_kind::view_commander_fire_geometry, "View Commander Fire Geometry" },
+	{ 1.3e16f, 1.3e16f, lod_kind::view_pilot_geometry, "View Pilot Geometry" },
+	{ 1.4e16f, 1.4e16f, lod_kind::view_pilot_fire_geometry, "View Pilot Fire Geometry" },
+	{ 1.5e16f, 1.5e16f, lod_kind::view_gunner_geometry, "View Gunner Geometry" },
+	{ 1.6e16f, 1.6e16f, lod_kind::view_gunner_fire_geometry, "View Gunner Fire Geometry" },
+	{ 1.7e16f, 1.7e16f, lod_kind::sub_parts, "Sub Parts" },
+	{ 1.8e16f, 1.8e16f, lod_kind::shadow_volume_view_cargo, "Shadow Volume - View Cargo" },
+	{ 1.9e16f, 1.9e16f, lod_kind::shadow_volume_view_pilot, "Shadow Volume - View Pilot" },
+	{ 2e16f, 2e16f, lod_kind::shadow_volume_view_gunner, "Shadow Volume - View Gunner" },
+	{ 2.1e16f, 2.1e16f, lod_kind::wreck, "Wreck" },
+};
+
+constexpr std::size_t lod_class_count = sizeof(lod_classes) / sizeof(lod_classes[0]);
+
+// binary search for the last class starting at or below resolution. special
+// values are written as floats, a small relative tolerance absorbs tools that
+// round them differently
+constexpr const lod_class* find_lod_class(const float resolution)
+{
+	std::size_t lo = 0;
+	std::size_t hi = lod_class_count;
+
+	while (lo < hi)
+	{
+		const auto mid = (lo + hi) / 2;
+		const auto& entry = lod_classes[mid];
+
+		if (entry.min <= resolution * (1.0f + 1e-6f))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo == 0)
+		return nullptr;
+
+	const auto& entry = lod_classes[lo - 1];
+
+	if (entry.min == entry.max)
+	{
+		const auto diff = resolution > entry.min ? resolution - entry.min : entry.min - resolution;
+		return diff <= entry.min * 1e-6f ? &entry : nullptr;
+	}
+
+	return resolution < entry.max ? &entry : nullptr;
+}
+
+constexpr lod_kind classify_lod(const float resolution)
+{
+	const auto* entry = find_lod_class(resolution);
+	return entry ? entry->kind : lod_kind::unknown;
+}
+
+static_assert(classify_lod(1.0f) == lod_kind::visual, "lod_classes out of order");
+static_assert(classify_lod(1e13f) == lod_kind::geometry, "lod_classes out of order");
+static_assert(classify_lod(10010.0f) == lod_kind::shadow_volume, "lod_classes out of order");
+static_assert(classify_lod(2.1e16f) == lod_kind::wreck, "lod_classes out of order");
+static_assert(classify_lod(5e14f) == lod_kind::unknown, "lod_classes out of order");
+
+struct mlod_p3d
+{
+	static constexpr std::uint32_t no_lod = ~std::uint32_t{ 0 };
+
+	p3d_header header;
+	std::vector<mlod_lod> lods;
+
+	using lod_index_map = std::array<std::uint32_t, static_cast<std::size_t>(lod_kind::count)>;
+
+	static constexpr lod_index_map empty_lod_map()
+	{
+		lod_index_map out{};
+		for (auto& index : out)
+			index = no_lod;
+		return out;
+	}
+
+	// first lod of every kind, built at parse time. empty until then so find()
+	// on a model that was never parsed or rebuilt returns nullptr
+	lod_index_map lod_map = empty_lod_map();
+
+	void rebuild_lod_map()
+	{
+		lod_map = empty_lod_map();
+
+		for (auto i = static_cast<std::uint32_t>(lods.size()); i-- > 0;)
+			lod_map[static_cast<std::size_t>(classify_lod(lods[i].resolution))] = i;
+	}
+
+	mlod_lod* find(const lod_kind kind)
+	{
+		const auto index = lod_map[static_cast<std::size_t>(kind)];
+		return index < lods.size() ? &lods[index] : nullptr;
+	}
+
+	const mlod_lod* find(const lod_kind kind) const
+	{
+		const auto index = lod_map[static_cast<std::size_t>(kind)];
+		return index < lods.size() ? &lods[index] : nullptr;
+	}
+
+	// an empty model, add lods and call rebuild_lod_map
+	static mlod_p3d create()
+	{
+		mlod_p3d out;
+		out.header.signature = { 'M', 'L', 'O', 'D' };
+		out.header.version = 0x101;
+		out.rebuild_lod_map();
+		return out;
+	}
+
+	static std::optional<mlod_error> parse(binary_reader& reader, mlod_p3d& out)
+	{
+		auto err = p3d_header::parse(reader, out.header);
+
+		if (err.has_value())
+			return err;
+
+		out.lods.resize(out.header.lod_count);
+
+		for (auto& lod : out.lods)
+		{
+			err = mlod_lod::parse(reader, lod);
+
+			if (err.has_value())
+				return err;
+		}
+
+		out.rebuild_lod_map();
+		return { };
+	}
+
+	static void write(binary_writer& writer, const mlod_p3d& in)
+	{
+		p3d_header::write(writer, in.header);
+
+		for (const auto& lod : in.lods)
+		{
+			mlod_lod::write(writer, lod);
+		}
+	}
+};
+
+#pragma pack(pop)
+
+// merges normals that fall into the same quantization cell and points every
+// vert_descriptor::normal_index at the surviving copy
+struct normal_dedup
+{
+	using normal_key = std::array<std::int32_t, 3>;
+
+	static std::int32_t quantize(const float value, const float inv_quantum)
+	{
+		const auto scaled = std::fmax(std::fmin(value * inv_quantum, 1073741823.0f), -1073741823.0f);
+		return static_cast<std::int32_t>(std::floor(scaled + 0.5f));
+	}
+
+	static std::uint32_t hash(const normal_key& key)
+	{
+		auto h = static_cast<std::uint32_t>(key[0]) * 73856093u
+			^ static_cast<std::uint32_t>(key[1]) * 19349663u
+			^ static_cast<std::uint32_t>(key[2]) * 83492791u;
+
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		return h;
+	}
+
+	// returns the number of normals removed from the lod
+	static std::uint32_t run(mlod_lod& lod, const float quantum = 1.0f / 4096.0f)
+	{
+		const auto count = static_cast<std::uint32_t>(lod.normals.size());
+
+		if (count == 0)
+			return 0;
+
+		// sized in size_t, count * 2 overflows uint32 past 2^31 normals
+		std::size_t capacity = 16;
+		while (capacity < std::size_t{ count } * 2)
+			capacity <<= 1;
+
+		constexpr auto empty_slot = std::numeric_limits<std::uint32_t>::max();
+		const auto mask = capacity - 1;
+		const auto inv_quantum = 1.0f / quantum;
+
+		// open addressing table of indices into unique/keys
+		std::vector<std::uint32_t> slots(capacity, empty_slot);
+		std::vector<normal_key> keys;
+		std::vector<vector3> unique;
+		std::vector<std::uint32_t> remap(count);
+
+		keys.reserve(count);
+		unique.reserve(count);
+
+		for (std::uint32_t i = 0; i < count; i++)
+		{
+			const auto& normal = lod.normals[i];
+
+			// never merge garbage, keep it as is
+			if (!std::isfinite(normal.x) || !std::isfinite(normal.y) || !std::isfinite(normal.z))
+			{
+				remap[i] = static_cast<std::uint32_t>(unique.size());
+				keys.push_back({});
+				unique.push_back(normal);
+				continue;
+			}
+
+			const normal_key key{
+				quantize(normal.x, inv_quantum),
+				quantize(normal.y, inv_quantum),
+				quantize(normal.z, inv_quantum) };
+
+			for (auto slot = hash(key) & mask;; slot = (slot + 1) & mask)
+			{
+				if (slots[slot] == empty_slot)
+				{
+					slots[slot] = static_cast<std::uint32_t>(unique.size());
+					remap[i] = slots[slot];
+					keys.push_back(key);
+					unique.push_back(normal);
+					break;
+				}
+
+				if (keys[slots[slot]] == key)
+				{
+					remap[i] = slots[slot];
+					break;
+				}
+			}
+		}
+
+		for (auto& face : lod.faces)
+		{
+			for (auto& desc : face.vertices)
+			{
+				if (desc.normal_index < count)
+					desc.normal_index = remap[desc.normal_index];
+			}
+		}
+
+		const auto removed = count - static_cast<std::uint32_t>(unique.size());
+
+		lod.normals = std::move(unique);
+		lod.num_face_normals = static_cast<std::uint32_t>(lod.normals.size());
+
+		return removed;
+	}
+};
+
+enum class normal_weighting
+{
+	area,
+	angle,
+	area_angle,
+};
+
+// rebuilds mlod_lod::normals as smooth per point normals, split along the
+// edges listed in the #SharpEdges# tag
+struct normal_generator
+{
+	// faces per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 4096;
+
+	static std::uint32_t find(std::vector<std::uint32_t>& parent, std::uint32_t i)
+	{
+		while (parent[i] != i)
+		{
+			parent[i] = parent[parent[i]];
+			i = parent[i];
+		}
+		return i;
+	}
+
+	static void unite(std::vector<std::uint32_t>& parent, const std::uint32_t a, const std::uint32_t b)
+	{
+		const auto ra = find(parent, a);
+		const auto rb = find(parent, b);
+
+		if (ra != rb)
+			parent[std::max(ra, rb)] = std::min(ra, rb);
+	}
+
+	// unnormalized face normals (length is twice the face area), 4 faces per iteration.
+	// faces wind clockwise when seen from the front, so the normal is diag1 x diag0.
+	// quads use the cross product of their diagonals, triangles repeat point 0 as
+	// the 4th corner which reduces to the usual edge cross product
+	static void face_normals(const mlod_lod& lod, const std::size_t begin, const std::size_t end,
+		float* nx, float* ny, float* nz)
+	{
+		const auto position = [&lod](const mlod_face& face, const std::uint32_t corner) -> const vector3&
+		{
+			const auto index = face.vertices[corner < face.corner_count() ? corner : 0].point_index;
+			static const vector3 origin{};
+			return index < lod.points.size() ? lod.points[index].pos : origin;
+		};
+
+		auto f = begin;
+
+		for (; f + 4 <= end; f += 4)
+		{
+			alignas(16) float x[4][4], y[4][4], z[4][4];
+
+			for (std::uint32_t lane = 0; lane < 4; lane++)
+			{
+				const auto& face = lod.faces[f + lane];
+
+				for (std::uint32_t corner = 0; corner < 4; corner++)
+				{
+					const auto& pos = position(face, corner);
+					x[corner][lane] = pos.x;
+					y[corner][lane] = pos.y;
+					z[corner][lane] = pos.z;
+				}
+			}
+
+			const auto ax = _mm_sub_ps(_mm_load_ps(x[2]), _mm_load_ps(x[0]));
+			const auto ay = _mm_sub_ps(_mm_load_ps(y[2]), _mm_load_ps(y[0]));
+			const auto az = _mm_sub_ps(_mm_load_ps(z[2]), _mm_load_ps(z[0]));
+			const auto bx = _mm_sub_ps(_mm_load_ps(x[3]), _mm_load_ps(x[1]));
+			const auto by = _mm_sub_ps(_mm_load_ps(y[3]), _mm_load_ps(y[1]));
+			const auto bz = _mm_sub_ps(_mm_load_ps(z[3]), _mm_load_ps(z[1]));
+
+			_mm_storeu_ps(nx + f, _mm_sub_ps(_mm_mul_ps(by, az), _mm_mul_ps(bz, ay)));
+			_mm_storeu_ps(ny + f, _mm_sub_ps(_mm_mul_ps(bz, ax), _mm_mul_ps(bx, az)));
+			_mm_storeu_ps(nz + f, _mm_sub_ps(_mm_mul_ps(bx, ay), _mm_mul_ps(by, ax)));
+		}
+
+		for (; f < end; f++)
+		{
+			const auto& face = lod.faces[f];
+			const auto& p0 = position(face, 0);
+			const auto& p1 = position(face, 1);
+			const auto& p2 = position(face, 2);
+			const auto& p3 = position(face, 3);
+
+			const vector3 a{ p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+			const vector3 b{ p3.x - p1.x, p3.y - p1.y, p3.z - p1.z };
+
+			nx[f] = b.y * a.z - b.z * a.y;
+			ny[f] = b.z * a.x - b.x * a.z;
+			nz[f] = b.x * a.y - b.y * a.x;
+		}
+	}
+
+	static float corner_angle(const mlod_lod& lod, const mlod_face& face, const std::uint32_t corner)
+	{
+		const auto n = face.corner_count();
+		const auto cur = face.vertices[corner].point_index;
+		const auto prev = face.vertices[(corner + n - 1) % n].point_index;
+		const auto next = face.vertices[(corner + 1) % n].point_index;
+
+		if (cur >= lod.points.size() || prev >= lod.points.size() || next >= lod.points.size())
+			return 0.0f;
+
+		const auto& p = lod.points[cur].pos;
+		const auto& a = lod.points[prev].pos;
+		const auto& b = lod.points[next].pos;
+
+		const vector3 e1{ a.x - p.x, a.y - p.y, a.z - p.z };
+		const vector3 e2{ b.x - p.x, b.y - p.y, b.z - p.z };
+
+		const auto cx = e1.y * e2.z - e1.z * e2.y;
+		const auto cy = e1.z * e2.x - e1.x * e2.z;
+		const auto cz = e1.x * e2.y - e1.y * e2.x;
+
+		return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), e1.x * e2.x + e1.y * e2.y + e1.z * e2.z);
+	}
+
+	static void run(mlod_lod& lod, const normal_weighting weighting = normal_weighting::angle)
+	{
+		const auto num_faces = lod.faces.size();
+		const auto num_corners = static_cast<std::uint32_t>(num_faces * 4);
+
+		aligned_vector<float> face_x(num_faces), face_y(num_faces), face_z(num_faces);
+		std::vector<float> weights(num_corners);
+
+		parallel_for(num_faces, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			face_normals(lod, begin, end, face_x.data(), face_y.data(), face_z.data());
+
+			for (auto f = begin; f < end; f++)
+			{
+				const auto& face = lod.faces[f];
+				const auto length = std::sqrt(face_x[f] * face_x[f] + face_y[f] * face_y[f] + face_z[f] * face_z[f]);
+
+				for (std::uint32_t c = 0; c < face.corner_count(); c++)
+				{
+					auto& weight = weights[f * 4 + c];
+
+					if (weighting == normal_weighting::area)
+						weight = 1.0f;
+					else if (weighting == normal_weighting::angle)
+						weight = length > 0.0f ? corner_angle(lod, face, c) / length : 0.0f;
+					else
+						weight = corner_angle(lod, face, c);
+				}
+			}
+		});
+
+		// corners sharing a point are joined across every edge that is not sharp
+		struct edge_record
+		{
+			std::uint64_t key;
+			std::uint32_t low_corner;
+			std::uint32_t high_corner;
+		};
+
+		std::vector<edge_record> edges;
+		edges.reserve(num_corners);
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			const auto& face = lod.faces[f];
+			const auto n = face.corner_count();
+
+			for (std::uint32_t c = 0; c < n; c++)
+			{
+				const auto next = (c + 1) % n;
+				const auto a = face.vertices[c].point_index;
+				const auto b = face.vertices[next].point_index;
+
+				if (a == b)
+					continue;
+
+				edges.push_back({ sharp_edges_tag::key(a, b), f * 4 + (a < b ? c : next), f * 4 + (a < b ? next : c) });
+			}
+		}
+
+		std::sort(edges.begin(), edges.end(), [](const edge_record& l, const edge_record& r) { return l.key < r.key; });
+
+		std::vector<std::uint32_t> parent(num_corners);
+		for (std::uint32_t i = 0; i < num_corners; i++)
+			parent[i] = i;
+
+		for (std::size_t run = 0, next = 0; run < edges.size(); run = next)
+		{
+			next = run + 1;
+			while (next < edges.size() && edges[next].key == edges[run].key)
+				next++;
+
+			if (lod.sharp_edges->contains(edges[run].key))
+				continue;
+
+			for (auto i = run + 1; i < next; i++)
+			{
+				unite(parent, edges[run].low_corner, edges[i].low_corner);
+				unite(parent, edges[run].high_corner, edges[i].high_corner);
+			}
+		}
+
+		// one normal per corner group, numbered in corner order. the union-find
+		// and the numbering stay serial, the sums and normalization are parallel
+		constexpr auto unassigned = std::numeric_limits<std::uint32_t>::max();
+		std::vector<std::uint32_t> group_normal(num_corners, unassigned);
+		std::vector<std::uint32_t> corner_normal(num_corners, unassigned);
+		std::uint32_t next_normal = 0;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			auto& face = lod.faces[f];
+
+			for (std::uint32_t c = 0; c < face.corner_count(); c++)
+			{
+				const auto corner = f * 4 + c;
+				auto& index = group_normal[find(parent, corner)];
+
+				if (index == unassigned)
+					index = next_normal++;
+
+				corner_normal[corner] = index;
+				face.vertices[c].normal_index = index;
+			}
+		}
+
+		const std::size_t num_normals = next_normal;
+
+		// corners of each normal in ascending order, so every sum adds up in the
+		// same order as a serial pass over the faces would
+		std::vector<std::uint32_t> first_member(num_normals + 1);
+		std::vector<std::uint32_t> members;
+
+		for (const auto index : corner_normal)
+		{
+			if (index != unassigned)
+				first_member[index + 1]++;
+		}
+
+		for (std::size_t i = 0; i < num_normals; i++)
+			first_member[i + 1] += first_member[i];
+
+		members.resize(first_member[num_normals]);
+
+		{
+			auto fill = first_member;
+
+			for (std::uint32_t corner = 0; corner < num_corners; corner++)
+			{
+				if (corner_normal[corner] != unassigned)
+					members[fill[corner_normal[corner]]++] = corner;
+			}
+		}
+
+		const auto padded = (num_normals + 3) & ~std::size_t{ 3 };
+		aligned_vector<float> sum_x(padded), sum_y(padded), sum_z(padded);
+
+		parallel_for(num_normals, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				float x = 0.0f, y = 0.0f, z = 0.0f;
+
+				for (auto m = first_member[i]; m < first_member[i + 1]; m++)
+				{
+					const auto corner = members[m];
+					const auto f = corner / 4;
+
+					x += face_x[f] * weights[corner];
+					y += face_y[f] * weights[corner];
+					z += face_z[f] * weights[corner];
+				}
+
+				sum_x[i] = x;
+				sum_y[i] = y;
+				sum_z[i] = z;
+			}
+		});
+
+		parallel_for(padded / 4, parallel_grain / 4, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin * 4; i < end * 4; i += 4)
+			{
+				const auto x = _mm_load_ps(sum_x.data() + i);
+				const auto y = _mm_load_ps(sum_y.data() + i);
+				const auto z = _mm_load_ps(sum_z.data() + i);
+
+				const auto length_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+				const auto valid = _mm_cmpgt_ps(length_sq, _mm_set1_ps(1e-30f));
+				const auto inv_length = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(length_sq, _mm_set1_ps(1e-30f))));
+
+				// degenerate groups fall back to +y
+				_mm_store_ps(sum_x.data() + i, _mm_and_ps(valid, _mm_mul_ps(x, inv_length)));
+				_mm_store_ps(sum_y.data() + i, _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(y, inv_length)), _mm_andnot_ps(valid, _mm_set1_ps(1.0f))));
+				_mm_store_ps(sum_z.data() + i, _mm_and_ps(valid, _mm_mul_ps(z, inv_length)));
+			}
+		});
+
+		lod.normals.resize(num_normals);
+
+		for (std::size_t i = 0; i < num_normals; i++)
+			lod.normals[i] = { sum_x[i], sum_y[i], sum_z[i] };
+
+		lod.num_face_normals = static_cast<std::uint32_t>(num_normals);
+	}
+};
+
+// one texture's placement inside an atlas
+struct atlas_remap
+{
+	std::string texture;
+	std::string new_texture;
+	float scale_u{ 1.0f };
+	float scale_v{ 1.0f };
+	float offset_u{};
+	float offset_v{};
+};
+
+// rescales and offsets the uvs of every face corner using a remapped texture,
+// in the primary channel as well as in every #UVSet# channel
+struct uv_atlas_remapper
+{
+	using lookup_table = std::unordered_map<std::string, const atlas_remap*>;
+
+	// texture paths are case insensitive
+	static std::string to_lower(std::string str)
+	{
+		for (auto& ch : str)
+			ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+		return str;
+	}
+
+	// u = u * scale + offset over a whole channel
+	static void remap_channel(float* uv, const float* scale, const float* offset, const std::size_t count)
+	{
+		std::size_t i = 0;
+
+		for (; i + 4 <= count; i += 4)
+			_mm_store_ps(uv + i, _mm_add_ps(_mm_mul_ps(_mm_load_ps(uv + i), _mm_load_ps(scale + i)), _mm_load_ps(offset + i)));
+
+		for (; i < count; i++)
+			uv[i] = uv[i] * scale[i] + offset[i];
+	}
+
+	static void run(mlod_lod& lod, const lookup_table& lookup)
+	{
+		const auto offsets = uv_set_tag::corner_offsets(lod.faces);
+		const auto corners = offsets.back();
+
+		aligned_vector<float> scale_u(corners, 1.0f), scale_v(corners, 1.0f);
+		aligned_vector<float> offset_u(corners), offset_v(corners);
+		bool any = false;
+
+		// lookups by the texture as written, so each distinct path is lowered once
+		std::unordered_map<std::string, const atlas_remap*> resolved;
+
+		for (std::size_t f = 0; f < lod.faces.size(); f++)
+		{
+			auto& face = lod.faces[f];
+			const auto [cached, added] = resolved.try_emplace(face.texture_name.string, nullptr);
+
+			if (added)
+			{
+				const auto it = lookup.find(to_lower(face.texture_name.string));
+				cached->second = it == lookup.end() ? nullptr : it->second;
+			}
+
+			if (cached->second == nullptr)
+				continue;
+
+			const auto& entry = *cached->second;
+
+			for (auto c = offsets[f]; c < offsets[f + 1]; c++)
+			{
+				scale_u[c] = entry.scale_u;
+				scale_v[c] = entry.scale_v;
+				offset_u[c] = entry.offset_u;
+				offset_v[c] = entry.offset_v;
+			}
+
+			for (std::uint32_t c = 0; c < face.corner_count(); c++)
+			{
+				auto& desc = face.vertices[c];
+				desc.u = desc.u * entry.scale_u + entry.offset_u;
+				desc.v = desc.v * entry.scale_v + entry.offset_v;
+			}
+
+			// an empty new_texture only moves the uvs
+			if (!entry.new_texture.empty())
+				face.texture_name.string = entry.new_texture;
+
+			any = true;
+		}
+
+		if (!any)
+			return;
+
+		// channels laid out for other faces are left alone, run(p3d) reports them
+		for (auto& uv_set : lod.uv_sets)
+		{
+			if (uv_set->u.size() != corners || uv_set->v.size() != corners)
+				continue;
+
+			auto& channel = uv_set.edit();
+			remap_channel(channel.u.data(), scale_u.data(), offset_u.data(), corners);
+			remap_channel(channel.v.data(), scale_v.data(), offset_v.data(), corners);
+		}
+	}
+
+	static std::optional<mlod_error> run(mlod_p3d& p3d, const std::vector<atlas_remap>& table)
+	{
+		// checked up front so a bad lod doesn't leave the model half remapped
+		for (const auto& lod : p3d.lods)
+		{
+			for (const auto& uv_set : lod.uv_sets)
+			{
+				if (!uv_set->matches(lod.faces))
+					return mlod_error("uv_atlas_remapper: #UVSet# corner count doesn't match the lod's faces");
+			}
+		}
+
+		lookup_table lookup;
+
+		for (const auto& entry : table)
+			lookup.emplace(to_lower(entry.texture), &entry);
+
+		parallel_for(p3d.lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				run(p3d.lods[i], lookup);
+		});
+
+		return {};
+	}
+};
+
+// scrubs through a lod's decoded #Animation# frames, linearly interpolating
+// between the two frames around the requested time
+struct animation_sampler
+{
+	// points per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 16384;
+
+	const std::vector<typed_tag<animation_tag>>* frames{};
+	std::vector<std::uint32_t> order;
+
+	explicit animation_sampler(const mlod_lod& lod) : frames(&lod.animations)
+	{
+		order.resize(frames->size());
+
+		for (std::uint32_t i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		// frames aren't required to be stored in time order
+		std::stable_sort(order.begin(), order.end(), [this](const std::uint32_t l, const std::uint32_t r)
+		{
+			return (*frames)[l]->time < (*frames)[r]->time;
+		});
+	}
+
+	static void lerp(const float* a, const float* b, float* out, const float t, const std::size_t begin, const std::size_t end)
+	{
+		const auto factor = _mm_set1_ps(t);
+		auto i = begin;
+
+		for (; i + 4 <= end; i += 4)
+		{
+			const auto va = _mm_loadu_ps(a + i);
+			const auto vb = _mm_loadu_ps(b + i);
+			_mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), factor)));
+		}
+
+		for (; i < end; i++)
+			out[i] = a[i] + (b[i] - a[i]) * t;
+	}
+
+	// out arrays must hold one entry per point, time is clamped to the frame range
+	std::optional<mlod_error> sample(const float time, float* x, float* y, float* z, const std::size_t num_points) const
+	{
+		if (order.empty())
+			return mlod_error("animation_sampler: lod has no #Animation# frames");
+
+		const auto upper = std::upper_bound(order.begin(), order.end(), time, [this](const float t, const std::uint32_t i)
+		{
+			return t < (*frames)[i]->time;
+		});
+
+		const auto& a = (*frames)[order[upper == order.begin() ? 0 : (upper - order.begin()) - 1]].get();
+		const auto& b = (*frames)[order[upper == order.end() ? order.size() - 1 : upper - order.begin()]].get();
+
+		if (a.x.size() < num_points || b.x.size() < num_points)
+			return mlod_error("animation_sampler: frame holds fewer positions than requested");
+
+		const auto span = b.time - a.time;
+		const auto t = span > 0.0f ? std::fmin(std::fmax((time - a.time) / span, 0.0f), 1.0f) : 0.0f;
+
+		parallel_for(num_points, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			lerp(a.x.data(), b.x.data(), x, t, begin, end);
+			lerp(a.y.data(), b.y.data(), y, t, begin, end);
+			lerp(a.z.data(), b.z.data(), z, t, begin, end);
+		});
+
+		return {};
+	}
+
+	std::optional<mlod_error> sample(const float time, aligned_vector<float>& x, aligned_vector<float>& y, aligned_vector<float>& z,
+		const std::size_t num_points) const
+	{
+		x.resize(num_points);
+		y.resize(num_points);
+		z.resize(num_points);
+
+		return sample(time, x.data(), y.data(), z.data(), num_points);
+	}
+
+	// poses the lod's points at the given time
+	std::optional<mlod_error> apply(const float time, mlod_lod& lod) const
+	{
+		aligned_vector<float> x, y, z;
+		auto err = sample(time, x, y, z, lod.points.size());
+
+		if (err.has_value())
+			return err;
+
+		for (std::size_t i = 0; i < lod.points.size(); i++)
+			lod.points[i].pos = { x[i], y[i], z[i] };
+
+		return {};
+	}
+};
+
+// 4x3 row vector transform, p' = p.x * m[0] + p.y * m[1] + p.z * m[2] + m[3]
+struct affine_transform
+{
+	std::array<std::array<float, 3>, 4> m{ {
+		{ 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f },
+		{ 0.0f, 0.0f, 0.0f } } };
+
+	static affine_transform scale(const float x, const float y, const float z)
+	{
+		affine_transform out;
+		out.m[0][0] = x;
+		out.m[1][1] = y;
+		out.m[2][2] = z;
+		return out;
+	}
+
+	static affine_transform translation(const float x, const float y, const float z)
+	{
+		affine_transform out;
+		out.m[3] = { x, y, z };
+		return out;
+	}
+
+	// rotation around a unit axis, angle in radians
+	static affine_transform rotation(const vector3& axis, const float angle)
+	{
+		const auto c = std::cos(angle);
+		const auto s = std::sin(angle);
+		const auto t = 1.0f - c;
+
+		affine_transform out;
+		out.m[0] = { t * axis.x * axis.x + c, t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y };
+		out.m[1] = { t * axis.x * axis.y - s * axis.z, t * axis.y * axis.y + c, t * axis.y * axis.z + s * axis.x };
+		out.m[2] = { t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, t * axis.z * axis.z + c };
+		return out;
+	}
+
+	// applies this transform first and next after it
+	affine_transform then(const affine_transform& next) const
+	{
+		affine_transform out;
+
+		for (std::size_t row = 0; row < 4; row++)
+		{
+			for (std::size_t col = 0; col < 3; col++)
+			{
+				out.m[row][col] = m[row][0] * next.m[0][col] + m[row][1] * next.m[1][col] + m[row][2] * next.m[2][col]
+					+ (row == 3 ? next.m[3][col] : 0.0f);
+			}
+		}
+
+		return out;
+	}
+
+	float determinant() const
+	{
+		return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+			+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	}
+
+	// inverse transpose of the linear part, up to a positive scale since normals
+	// get renormalized anyway. that is the cofactor matrix, which also keeps
+	// singular matrices from blowing up
+	affine_transform normal_matrix() const
+	{
+		const auto sign = determinant() < 0.0f ? -1.0f : 1.0f;
+		affine_transform out;
+
+		for (std::size_t row = 0; row < 3; row++)
+		{
+			const auto r1 = (row + 1) % 3;
+			const auto r2 = (row + 2) % 3;
+
+			for (std::size_t col = 0; col < 3; col++)
+			{
+				const auto c1 = (col + 1) % 3;
+				const auto c2 = (col + 2) % 3;
+
+				out.m[row][col] = sign * (m[r1][c1] * m[r2][c2] - m[r1][c2] * m[r2][c1]);
+			}
+		}
+
+		return out;
+	}
+};
+
+// applies an affine transform to every point, normal and #Animation# frame of a
+// model. positions go through the full matrix, normals through its inverse
+// transpose. mirroring transforms also reverse face winding to keep faces front facing
+struct transform_engine
+{
+	// elements per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 16384;
+
+	// mlod_point is packed as x, y, z, flags, so a point is exactly one sse register
+	static void transform_points(mlod_point* points, const std::size_t count, const affine_transform& t)
+	{
+		const auto row0 = _mm_setr_ps(t.m[0][0], t.m[0][1], t.m[0][2], 0.0f);
+		const auto row1 = _mm_setr_ps(t.m[1][0], t.m[1][1], t.m[1][2], 0.0f);
+		const auto row2 = _mm_setr_ps(t.m[2][0], t.m[2][1], t.m[2][2], 0.0f);
+		const auto row3 = _mm_setr_ps(t.m[3][0], t.m[3][1], t.m[3][2], 0.0f);
+		const auto flags_mask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+		static_assert(sizeof(mlod_point) == 16, "mlod_point must stay packed");
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			auto* ptr = reinterpret_cast<float*>(points + i);
+			const auto p = _mm_loadu_ps(ptr);
+
+			auto r = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), row0), row3);
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), row1));
+			r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+
+			_mm_storeu_ps(ptr, _mm_or_ps(_mm_andnot_ps(flags_mask, r), _mm_and_ps(flags_mask, p)));
+		}
+	}
+
+	// SoA positions such as animation frames
+	static void transform_soa(float* x, float* y, float* z, const std::size_t count, const affine_transform& t, const bool normalize)
+	{
+		const auto lane = [](const float v) { return _mm_set1_ps(v); };
+		std::size_t i = 0;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const auto vx = _mm_loadu_ps(x + i);
+			const auto vy = _mm_loadu_ps(y + i);
+			const auto vz = _mm_loadu_ps(z + i);
+
+			auto rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, lane(t.m[0][0])), _mm_mul_ps(vy, lane(t.m[1][0]))), _mm_add_ps(_mm_mul_ps(vz, lane(t.m[2][0])), lane(t.m[3][0])));
+			auto ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, lane(t.m[0][1])), _mm_mul_ps(vy, lane(t.m[1][1]))), _mm_add_ps(_mm_mul_ps(vz, lane(t.m[2][1])), lane(t.m[3][1])));
+			auto rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, lane(t.m[0][2])), _mm_mul_ps(vy, lane(t.m[1][2]))), _mm_add_ps(_mm_mul_ps(vz, lane(t.m[2][2])), lane(t.m[3][2])));
+
+			if (normalize)
+			{
+				const auto length_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz));
+				const auto valid = _mm_cmpgt_ps(length_sq, lane(1e-30f));
+				const auto inv_length = _mm_and_ps(valid, _mm_div_ps(lane(1.0f), _mm_sqrt_ps(_mm_max_ps(length_sq, lane(1e-30f)))));
+
+				rx = _mm_mul_ps(rx, inv_length);
+				ry = _mm_mul_ps(ry, inv_length);
+				rz = _mm_mul_ps(rz, inv_length);
+			}
+
+			_mm_storeu_ps(x + i, rx);
+			_mm_storeu_ps(y + i, ry);
+			_mm_storeu_ps(z + i, rz);
+		}
+
+		for (; i < count; i++)
+		{
+			auto rx = x[i] * t.m[0][0] + y[i] * t.m[1][0] + z[i] * t.m[2][0] + t.m[3][0];
+			auto ry = x[i] * t.m[0][1] + y[i] * t.m[1][1] + z[i] * t.m[2][1] + t.m[3][1];
+			auto rz = x[i] * t.m[0][2] + y[i] * t.m[1][2] + z[i] * t.m[2][2] + t.m[3][2];
+
+			if (normalize)
+			{
+				const auto length = std::sqrt(rx * rx + ry * ry + rz * rz);
+				const auto inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+				rx *= inv_length;
+				ry *= inv_length;
+				rz *= inv_length;
+			}
+
+			x[i] = rx;
+			y[i] = ry;
+			z[i] = rz;
+		}
+	}
+
+	static void transform_normals(vector3* normals, const std::size_t count, const affine_transform& normal_matrix)
+	{
+		// staged through small SoA blocks, vector3 has a 12 byte stride
+		constexpr std::size_t block = 256;
+		alignas(16) float x[block], y[block], z[block];
+
+		for (std::size_t begin = 0; begin < count; begin += block)
+		{
+			const auto n = std::min(block, count - begin);
+
+			for (std::size_t i = 0; i < n; i++)
+			{
+				x[i] = normals[begin + i].x;
+				y[i] = normals[begin + i].y;
+				z[i] = normals[begin + i].z;
+			}
+
+			transform_soa(x, y, z, n, normal_matrix, true);
+
+			for (std::size_t i = 0; i < n; i++)
+				normals[begin + i] = { x[i], y[i], z[i] };
+		}
+	}
+
+	// #Animation# frames laid out like the point list, marked for editing up front
+	// so that point ranges can be transformed from any thread
+	static std::vector<animation_tag*> point_frames(mlod_lod& lod)
+	{
+		std::vector<animation_tag*> frames;
+
+		for (auto& frame : lod.animations)
+		{
+			if (frame->x.size() == lod.points.size())
+				frames.push_back(&frame.edit());
+		}
+
+		return frames;
+	}
+
+	static void transform_point_range(mlod_lod& lod, const std::vector<animation_tag*>& frames, const affine_transform& t, const std::size_t begin, const std::size_t end)
+	{
+		transform_points(lod.points.data() + begin, end - begin, t);
+
+		for (auto* anim : frames)
+			transform_soa(anim->x.data() + begin, anim->y.data() + begin, anim->z.data() + begin, end - begin, t, false);
+	}
+
+	// mirroring transforms flip the winding, the face corners and their #UVSet#
+	// corners are reversed a range of faces at a time
+	struct winding_reversal
+	{
+		std::vector<std::uint32_t> offsets;
+		std::vector<uv_set_tag*> channels;
+
+		explicit winding_reversal(mlod_lod& lod) : offsets(uv_set_tag::corner_offsets(lod.faces))
+		{
+			for (auto& uv_set : lod.uv_sets)
+			{
+				if (uv_set->u.size() == offsets.back())
+					channels.push_back(&uv_set.edit());
+			}
+		}
+
+		void run(mlod_lod& lod, const std::size_t begin, const std::size_t end) const
+		{
+			for (auto f = begin; f < end; f++)
+			{
+				auto& face = lod.faces[f];
+				std::reverse(face.vertices.begin(), face.vertices.begin() + face.corner_count());
+
+				for (auto* channel : channels)
+				{
+					std::reverse(channel->u.begin() + offsets[f], channel->u.begin() + offsets[f + 1]);
+					std::reverse(channel->v.begin() + offsets[f], channel->v.begin() + offsets[f + 1]);
+				}
+			}
+		}
+	};
+
+	static void apply(mlod_lod& lod, const affine_transform& t)
+	{
+		const auto normal_matrix = t.normal_matrix();
+		const auto frames = point_frames(lod);
+
+		parallel_for(lod.points.size(), parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			transform_point_range(lod, frames, t, begin, end);
+		});
+
+		parallel_for(lod.normals.size(), parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			transform_normals(lod.normals.data() + begin, end - begin, normal_matrix);
+		});
+
+		if (t.determinant() < 0.0f)
+		{
+			const winding_reversal reversal(lod);
+
+			parallel_for(lod.faces.size(), parallel_grain, [&](const std::size_t begin, const std::size_t end)
+			{
+				reversal.run(lod, begin, end);
+			});
+		}
+	}
+
+	// transforms are applied in order, fused into a single matrix and a single pass.
+	// with at least a lod per thread, or no lod big enough to split, lods run in
+	// parallel and each one inline. otherwise a few large lods go one at a time,
+	// each pass parallel over the lod's own elements
+	static void apply(mlod_p3d& p3d, const std::vector<affine_transform>& transforms)
+	{
+		affine_transform fused;
+
+		for (const auto& t : transforms)
+			fused = fused.then(t);
+
+		const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+		const auto large = std::any_of(p3d.lods.begin(), p3d.lods.end(), [](const mlod_lod& lod)
+		{
+			return std::max({ lod.points.size(), lod.normals.size(), lod.faces.size() }) > parallel_grain;
+		});
+
+		if (p3d.lods.size() >= hw || !large)
+		{
+			parallel_for(p3d.lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+			{
+				for (auto i = begin; i < end; i++)
+					apply(p3d.lods[i], fused);
+			});
+			return;
+		}
+
+		for (auto& lod : p3d.lods)
+			apply(lod, fused);
+	}
+};
+
+// keeps the per point and per face tags of a lod in step when points or faces
+// are merged, removed or reordered
+struct lod_remap
+{
+	static constexpr std::uint32_t removed = ~std::uint32_t{ 0 };
+
+	// named selections and the editor's own selection-like tags share one layout,
+	// a weight byte per point followed by a weight byte per face
+	static bool is_selection(const mlod_tag& tag)
+	{
+		const auto& name = tag.tag_name.string;
+		return (!name.empty() && name[0] != '#') || name == "#Selected#" || name == "#Hidden#" || name == "#Lock#";
+	}
+
+	// point_map[old] is the new index of each point or removed. several old points
+	// may share a new index, the first of them survives
+	static void remap_points(mlod_lod& lod, const std::vector<std::uint32_t>& point_map, const std::uint32_t new_count)
+	{
+		const auto old_count = static_cast<std::uint32_t>(lod.points.size());
+		std::vector<std::uint32_t> survivor(new_count, removed);
+
+		for (std::uint32_t i = 0; i < old_count; i++)
+		{
+			if (point_map[i] != removed && survivor[point_map[i]] == removed)
+				survivor[point_map[i]] = i;
+		}
+
+		std::vector<mlod_point> points(new_count);
+		for (std::uint32_t i = 0; i < new_count; i++)
+			points[i] = lod.points[survivor[i]];
+
+		lod.points = std::move(points);
+		lod.num_points = new_count;
+
+		for (auto& face : lod.faces)
+		{
+			for (std::uint32_t c = 0; c < face.corner_count(); c++)
+			{
+				auto& index = face.vertices[c].point_index;
+
+				if (index < old_count && point_map[index] != removed)
+					index = point_map[index];
+			}
+		}
+
+		const auto num_faces = lod.faces.size();
+
+		for (auto& tag : lod.tags)
+		{
+			if (!is_selection(tag) || tag.data.size() != old_count + num_faces)
+				continue;
+
+			std::vector<std::uint8_t> data(new_count + num_faces);
+
+			for (std::uint32_t i = 0; i < old_count; i++)
+			{
+				if (point_map[i] != removed && data[point_map[i]] == 0)
+					data[point_map[i]] = tag.data[i];
+			}
+
+			std::copy(tag.data.begin() + old_count, tag.data.end(), data.begin() + new_count);
+
+			tag.data = std::move(data);
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+		}
+
+		if (lod.mass.tag_index != typed_tag<mass_tag>::detached || lod.mass.dirty)
+		{
+			// merged points pool their mass
+			auto& mass = lod.mass.edit().mass;
+			std::vector<float> merged(new_count);
+
+			for (std::uint32_t i = 0; i < old_count && i < mass.size(); i++)
+			{
+				if (point_map[i] != removed)
+					merged[point_map[i]] += mass[i];
+			}
+
+			mass = std::move(merged);
+		}
+
+		for (auto& frame : lod.animations)
+		{
+			auto& anim = frame.edit();
+
+			if (anim.x.size() != old_count)
+				continue;
+
+			aligned_vector<float> x(new_count), y(new_count), z(new_count);
+
+			for (std::uint32_t i = 0; i < new_count; i++)
+			{
+				x[i] = anim.x[survivor[i]];
+				y[i] = anim.y[survivor[i]];
+				z[i] = anim.z[survivor[i]];
+			}
+
+			anim.x = std::move(x);
+			anim.y = std::move(y);
+			anim.z = std::move(z);
+		}
+
+		if (!lod.sharp_edges->edges().empty())
+		{
+			sharp_edges_tag edges;
+
+			for (const auto& edge : lod.sharp_edges->edges())
+			{
+				if (edge[0] < old_count && edge[1] < old_count && point_map[edge[0]] != removed && point_map[edge[1]] != removed)
+					edges.insert(point_map[edge[0]], point_map[edge[1]]);
+			}
+
+			lod.sharp_edges.edit() = std::move(edges);
+		}
+	}
+
+	// face_map[old] is the new index of each face or removed, the first face
+	// mapped to a new index survives
+	static void remap_faces(mlod_lod& lod, const std::vector<std::uint32_t>& face_map, const std::uint32_t new_count)
+	{
+		const auto old_count = static_cast<std::uint32_t>(lod.faces.size());
+		const auto old_offsets = uv_set_tag::corner_offsets(lod.faces);
+		std::vector<std::uint32_t> survivor(new_count, removed);
+
+		for (std::uint32_t i = 0; i < old_count; i++)
+		{
+			if (face_map[i] != removed && survivor[face_map[i]] == removed)
+				survivor[face_map[i]] = i;
+		}
+
+		std::vector<mlod_face> faces(new_count);
+		for (std::uint32_t i = 0; i < new_count; i++)
+			faces[i] = std::move(lod.faces[survivor[i]]);
+
+		const auto num_points = lod.points.size();
+
+		for (auto& tag : lod.tags)
+		{
+			if (!is_selection(tag) || tag.data.size() != num_points + old_count)
+				continue;
+
+			std::vector<std::uint8_t> weights(new_count);
+			for (std::uint32_t i = 0; i < new_count; i++)
+				weights[i] = tag.data[num_points + survivor[i]];
+
+			tag.data.resize(num_points + new_count);
+			std::copy(weights.begin(), weights.end(), tag.data.begin() + static_cast<std::ptrdiff_t>(num_points));
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+		}
+
+		for (auto& uv_set : lod.uv_sets)
+		{
+			if (uv_set->u.size() != old_offsets.back())
+				continue;
+
+			auto& channel = uv_set.edit();
+			aligned_vector<float> u, v;
+			u.reserve(channel.u.size());
+			v.reserve(channel.v.size());
+
+			for (std::uint32_t i = 0; i < new_count; i++)
+			{
+				const auto f = survivor[i];
+				u.insert(u.end(), channel.u.begin() + old_offsets[f], channel.u.begin() + old_offsets[f + 1]);
+				v.insert(v.end(), channel.v.begin() + old_offsets[f], channel.v.begin() + old_offsets[f + 1]);
+			}
+
+			channel.u = std::move(u);
+			channel.v = std::move(v);
+		}
+
+		lod.faces = std::move(faces);
+		lod.num_faces = new_count;
+	}
+
+	// appends faces, a new face joins every selection holding all of its points
+	// and gets zeroed corners in every #UVSet# channel
+	static void append_faces(mlod_lod& lod, std::vector<mlod_face> faces)
+	{
+		const auto num_points = lod.points.size();
+		const auto old_count = lod.faces.size();
+		const auto old_corners = uv_set_tag::corner_offsets(lod.faces).back();
+
+		for (auto& tag : lod.tags)
+		{
+			if (!is_selection(tag) || tag.data.size() != num_points + old_count)
+				continue;
+
+			for (const auto& face : faces)
+			{
+				auto selected = true;
+
+				for (std::uint32_t c = 0; c < face.corner_count() && selected; c++)
+				{
+					const auto index = face.vertices[c].point_index;
+					selected = index < num_points && tag.data[index] != 0;
+				}
+
+				tag.data.push_back(selected ? 1 : 0);
+			}
+
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+		}
+
+		std::uint32_t new_corners = 0;
+		for (const auto& face : faces)
+			new_corners += face.corner_count();
+
+		for (auto& uv_set : lod.uv_sets)
+		{
+			if (uv_set->u.size() != old_corners)
+				continue;
+
+			auto& channel = uv_set.edit();
+			channel.u.resize(channel.u.size() + new_corners);
+			channel.v.resize(channel.v.size() + new_corners);
+		}
+
+		for (auto& face : faces)
+			lod.faces.push_back(std::move(face));
+
+		lod.num_faces = static_cast<std::uint32_t>(lod.faces.size());
+	}
+
+	// splits every quad 0,1,2,3 into 0,1,2 and 0,2,3. both halves keep the quad's
+	// selection weights and #UVSet# corners
+	static void split_quads(mlod_lod& lod)
+	{
+		const auto old_count = static_cast<std::uint32_t>(lod.faces.size());
+		const auto old_offsets = uv_set_tag::corner_offsets(lod.faces);
+		std::vector<std::uint32_t> source;
+		std::vector<std::uint8_t> first_corner;
+
+		source.reserve(old_count * 2);
+		first_corner.reserve(old_count * 2);
+
+		for (std::uint32_t f = 0; f < old_count; f++)
+		{
+			source.push_back(f);
+			first_corner.push_back(0);
+
+			if (lod.faces[f].corner_count() == 4)
+			{
+				source.push_back(f);
+				first_corner.push_back(1);
+			}
+		}
+
+		const auto new_count = static_cast<std::uint32_t>(source.size());
+
+		if (new_count == old_count)
+			return;
+
+		// corners of each half in the source face, the second half skips corner 1
+		constexpr std::uint32_t halves[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+
+		std::vector<mlod_face> faces(new_count);
+
+		for (std::uint32_t i = 0; i < new_count; i++)
+		{
+			const auto& face = lod.faces[source[i]];
+			auto& out = faces[i];
+
+			out.face_type = 3;
+			out.vertices.resize(4);
+			out.face_flags = face.face_flags;
+			out.texture_name = face.texture_name;
+			out.material_name = face.material_name;
+
+			for (std::uint32_t c = 0; c < 3; c++)
+				out.vertices[c] = face.vertices[halves[first_corner[i]][c]];
+		}
+
+		const auto num_points = lod.points.size();
+
+		for (auto& tag : lod.tags)
+		{
+			if (!is_selection(tag) || tag.data.size() != num_points + old_count)
+				continue;
+
+			std::vector<std::uint8_t> data(num_points + new_count);
+			std::copy(tag.data.begin(), tag.data.begin() + static_cast<std::ptrdiff_t>(num_points), data.begin());
+
+			for (std::uint32_t i = 0; i < new_count; i++)
+				data[num_points + i] = tag.data[num_points + source[i]];
+
+			tag.data = std::move(data);
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+		}
+
+		for (auto& uv_set : lod.uv_sets)
+		{
+			if (uv_set->u.size() != old_offsets.back())
+				continue;
+
+			auto& channel = uv_set.edit();
+			aligned_vector<float> u(new_count * 3), v(new_count * 3);
+
+			for (std::uint32_t i = 0; i < new_count; i++)
+			{
+				for (std::uint32_t c = 0; c < 3; c++)
+				{
+					const auto corner = old_offsets[source[i]] + halves[first_corner[i]][c];
+					u[i * 3 + c] = channel.u[corner];
+					v[i * 3 + c] = channel.v[corner];
+				}
+			}
+
+			channel.u = std::move(u);
+			channel.v = std::move(v);
+		}
+
+		lod.faces = std::move(faces);
+		lod.num_faces = new_count;
+	}
+};
+
+enum class pipeline_stage_kind
+{
+	point,
+	normal,
+	face,
+	whole_lod,
+};
+
+// chains per element passes over a lod. consecutive point, normal and face
+// stages are fused, each array is walked once in cache sized chunks with every
+// stage applied to a chunk before moving on. whole_lod stages (weld, compact,
+// normal rebuild, ...) act as barriers between fused groups. lods run in parallel.
+//
+// within a fused group all point stages run before the normal stages, which run
+// before the face stages, so face stages always see final positions
+struct lod_pipeline
+{
+	// elements per chunk, sized to keep a chunk of points and its tag data in L1/L2
+	static constexpr std::size_t chunk_size = 2048;
+	// elements per thread before a single lod's traversal is parallelized
+	static constexpr std::size_t parallel_grain = 65536;
+
+	using range_fn = std::function<void(std::size_t begin, std::size_t end)>;
+	// called once per lod before its traversal, returns the kernel bound to that lod
+	using bind_fn = std::function<range_fn(mlod_lod& lod)>;
+	using whole_lod_fn = std::function<void(mlod_lod& lod)>;
+
+	struct stage
+	{
+		pipeline_stage_kind kind;
+		bind_fn bind;
+		whole_lod_fn whole_lod;
+	};
+
+	std::vector<stage> stages;
+
+	lod_pipeline& points(bind_fn fn)
+	{
+		stages.push_back({ pipeline_stage_kind::point, std::move(fn), {} });
+		return *this;
+	}
+
+	lod_pipeline& normals(bind_fn fn)
+	{
+		stages.push_back({ pipeline_stage_kind::normal, std::move(fn), {} });
+		return *this;
+	}
+
+	lod_pipeline& faces(bind_fn fn)
+	{
+		stages.push_back({ pipeline_stage_kind::face, std::move(fn), {} });
+		return *this;
+	}
+
+	lod_pipeline& whole_lod(whole_lod_fn fn)
+	{
+		stages.push_back({ pipeline_stage_kind::whole_lod, {}, std::move(fn) });
+		return *this;
+	}
+
+	// transform_engine::apply split into its point, normal and face passes so they
+	// fuse with neighbouring stages: positions and #Animation# frames, normals, and
+	// the winding reversal of mirroring transforms
+	lod_pipeline& transform(const affine_transform& t)
+	{
+		points([t](mlod_lod& lod) -> range_fn
+		{
+			return [&lod, t, frames = transform_engine::point_frames(lod)](const std::size_t begin, const std::size_t end)
+			{
+				transform_engine::transform_point_range(lod, frames, t, begin, end);
+			};
+		});
+
+		normals([normal_matrix = t.normal_matrix()](mlod_lod& lod) -> range_fn
+		{
+			return [&lod, normal_matrix](const std::size_t begin, const std::size_t end)
+			{
+				transform_engine::transform_normals(lod.normals.data() + begin, end - begin, normal_matrix);
+			};
+		});
+
+		if (t.determinant() < 0.0f)
+		{
+			faces([](mlod_lod& lod) -> range_fn
+			{
+				auto reversal = std::make_shared<const transform_engine::winding_reversal>(lod);
+
+				return [&lod, reversal](const std::size_t begin, const std::size_t end)
+				{
+					reversal->run(lod, begin, end);
+				};
+			});
+		}
+
+		return *this;
+	}
+
+	// merges points with equal flags that lie within epsilon of each other
+	lod_pipeline& weld(const float epsilon)
+	{
+		return whole_lod([epsilon](mlod_lod& lod) { weld_points(lod, epsilon); });
+	}
+
+	// drops points that no face uses and no selection holds, and unused normals
+	lod_pipeline& compact()
+	{
+		return whole_lod([](mlod_lod& lod) { compact_lod(lod); });
+	}
+
+	lod_pipeline& dedup_normals(const float quantum = 1.0f / 4096.0f)
+	{
+		return whole_lod([quantum](mlod_lod& lod) { normal_dedup::run(lod, quantum); });
+	}
+
+	lod_pipeline& rebuild_normals(const normal_weighting weighting = normal_weighting::angle)
+	{
+		return whole_lod([weighting](mlod_lod& lod) { normal_generator::run(lod, weighting); });
+	}
+
+	static void weld_points(mlod_lod& lod, const float epsilon)
+	{
+		const auto count = static_cast<std::uint32_t>(lod.points.size());
+		const auto inv_cell = 1.0 / std::max(static_cast<double>(epsilon), 1e-12);
+		const auto epsilon_sq = epsilon * epsilon;
+
+		// clamped well inside int64 so far off or non-finite coordinates only share
+		// a cell rather than overflow the conversion, the distance test still decides
+		const auto cell_of = [inv_cell](const float v)
+		{
+			constexpr double limit = 1ll << 40;
+			const auto cell = std::floor(static_cast<double>(v) * inv_cell);
+			return static_cast<std::int64_t>(cell == cell ? std::clamp(cell, -limit, limit) : 0.0);
+		};
+
+		const auto cell_key = [](const std::int64_t x, const std::int64_t y, const std::int64_t z)
+		{
+			return (static_cast<std::uint64_t>(x) & 0x1fffff)
+				| ((static_cast<std::uint64_t>(y) & 0x1fffff) << 21)
+				| ((static_cast<std::uint64_t>(z) & 0x1fffff) << 42);
+		};
+
+		// chained grid of surviving points
+		std::unordered_map<std::uint64_t, std::uint32_t> heads;
+		std::vector<std::uint32_t> next(count, lod_remap::removed);
+		std::vector<std::uint32_t> point_map(count);
+		std::vector<std::uint32_t> survivors;
+
+		heads.reserve(count);
+
+		for (std::uint32_t i = 0; i < count; i++)
+		{
+			const auto& p = lod.points[i];
+			const auto cx = cell_of(p.pos.x), cy = cell_of(p.pos.y), cz = cell_of(p.pos.z);
+			auto match = lod_remap::removed;
+
+			for (auto dx = -1; dx <= 1 && match == lod_remap::removed; dx++)
+			{
+				for (auto dy = -1; dy <= 1 && match == lod_remap::removed; dy++)
+				{
+					for (auto dz = -1; dz <= 1 && match == lod_remap::removed; dz++)
+					{
+						const auto it = heads.find(cell_key(cx + dx, cy + dy, cz + dz));
+
+						for (auto j = it == heads.end() ? lod_remap::removed : it->second; j != lod_remap::removed; j = next[j])
+						{
+							const auto& q = lod.points[j];
+							const auto ex = q.pos.x - p.pos.x, ey = q.pos.y - p.pos.y, ez = q.pos.z - p.pos.z;
+
+							if (q.flags == p.flags && ex * ex + ey * ey + ez * ez <= epsilon_sq)
+							{
+								match = j;
+								break;
+							}
+						}
+					}
+				}
+			}
+
+			if (match != lod_remap::removed)
+			{
+				point_map[i] = point_map[match];
+				continue;
+			}
+
+			point_map[i] = static_cast<std::uint32_t>(survivors.size());
+			survivors.push_back(i);
+
+			auto& head = heads.try_emplace(cell_key(cx, cy, cz), lod_remap::removed).first->second;
+			next[i] = head;
+			head = i;
+		}
+
+		if (survivors.size() != count)
+			lod_remap::remap_points(lod, point_map, static_cast<std::uint32_t>(survivors.size()));
+	}
+
+	static void compact_lod(mlod_lod& lod)
+	{
+		const auto num_points = static_cast<std::uint32_t>(lod.points.size());
+		const auto num_normals = static_cast<std::uint32_t>(lod.normals.size());
+		std::vector<std::uint8_t> used_points(num_points), used_normals(num_normals);
+
+		for (const auto& face : lod.faces)
+		{
+			for (std::uint32_t c = 0; c < face.corner_count(); c++)
+			{
+				if (face.vertices[c].point_index < num_points)
+					used_points[face.vertices[c].point_index] = 1;
+
+				if (face.vertices[c].normal_index < num_normals)
+					used_normals[face.vertices[c].normal_index] = 1;
+			}
+		}
+
+		// memory points and the like only live in selections
+		for (const auto& tag : lod.tags)
+		{
+			if (!lod_remap::is_selection(tag) || tag.data.size() != num_points + lod.faces.size())
+				continue;
+
+			for (std::uint32_t i = 0; i < num_points; i++)
+				used_points[i] |= tag.data[i] != 0;
+		}
+
+		std::vector<std::uint32_t> point_map(num_points, lod_remap::removed);
+		std::uint32_t kept_points = 0;
+
+		for (std::uint32_t i = 0; i < num_points; i++)
+		{
+			if (used_points[i])
+				point_map[i] = kept_points++;
+		}
+
+		if (kept_points != num_points)
+			lod_remap::remap_points(lod, point_map, kept_points);
+
+		std::vector<std::uint32_t> normal_map(num_normals, lod_remap::removed);
+		std::vector<vector3> normals;
+
+		for (std::uint32_t i = 0; i < num_normals; i++)
+		{
+			if (used_normals[i])
+			{
+				normal_map[i] = static_cast<std::uint32_t>(normals.size());
+				normals.push_back(lod.normals[i]);
+			}
+		}
+
+		for (auto& face : lod.faces)
+		{
+			for (std::uint32_t c = 0; c < face.corner_count(); c++)
+			{
+				if (face.vertices[c].normal_index < num_normals)
+					face.vertices[c].normal_index = normal_map[face.vertices[c].normal_index];
+			}
+		}
+
+		lod.normals = std::move(normals);
+		lod.num_face_normals = static_cast<std::uint32_t>(lod.normals.size());
+	}
+
+	static void traverse(const std::vector<range_fn>& kernels, const std::size_t count)
+	{
+		if (kernels.empty())
+			return;
+
+		parallel_for(count, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto chunk = begin; chunk < end; chunk += chunk_size)
+			{
+				const auto chunk_end = std::min(chunk + chunk_size, end);
+
+				for (const auto& kernel : kernels)
+					kernel(chunk, chunk_end);
+			}
+		});
+	}
+
+	void run(mlod_lod& lod) const
+	{
+		for (std::size_t group = 0; group < stages.size();)
+		{
+			if (stages[group].kind == pipeline_stage_kind::whole_lod)
+			{
+				stages[group++].whole_lod(lod);
+				continue;
+			}
+
+			std::vector<range_fn> point_kernels, normal_kernels, face_kernels;
+
+			for (; group < stages.size() && stages[group].kind != pipeline_stage_kind::whole_lod; group++)
+			{
+				auto kernel = stages[group].bind(lod);
+
+				if (stages[group].kind == pipeline_stage_kind::point)
+					point_kernels.push_back(std::move(kernel));
+				else if (stages[group].kind == pipeline_stage_kind::normal)
+					normal_kernels.push_back(std::move(kernel));
+				else
+					face_kernels.push_back(std::move(kernel));
+			}
+
+			traverse(point_kernels, lod.points.size());
+			traverse(normal_kernels, lod.normals.size());
+			traverse(face_kernels, lod.faces.size());
+		}
+	}
+
+	void run(mlod_p3d& p3d) const
+	{
+		parallel_for(p3d.lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				run(p3d.lods[i]);
+		});
+	}
+};
+
+struct ray
+{
+	vector3 origin;
+	vector3 direction;
+	float t_max{ std::numeric_limits<float>::infinity() };
+};
+
+struct ray_hit
+{
+	float t{ std::numeric_limits<float>::infinity() };
+	// index into mlod_lod::faces, or none on a miss
+	std::uint32_t face{ none };
+	// barycentrics within the hit triangle
+	float u{};
+	float v{};
+
+	static constexpr std::uint32_t none = ~std::uint32_t{ 0 };
+
+	bool hit() const { return face != none; }
+};
+
+// binned SAH bounding volume hierarchy over a lod's faces, quads split into two
+// triangles. built in parallel, traversed one ray at a time or in SSE packets of 4
+struct lod_bvh
+{
+	static constexpr std::uint32_t bin_count = 16;
+	static constexpr std::uint32_t max_leaf_size = 8;
+	// subtrees below this many triangles are never built on their own thread
+	static constexpr std::size_t parallel_grain = 16384;
+	// past this depth nodes are split at the median, which halves the range so
+	// at most 32 more levels follow. traversal stacks are sized from it
+	static constexpr std::uint32_t max_sah_depth = 64;
+	static constexpr std::uint32_t stack_capacity = max_sah_depth + 32;
+
+	struct node
+	{
+		float min[3];
+		float max[3];
+		// first triangle for leaves, right child for interior nodes (left child is the next node)
+		std::uint32_t offset;
+		std::uint16_t count;
+		std::uint16_t axis;
+	};
+
+	// precomputed for Moller-Trumbore
+	struct triangle
+	{
+		vector3 v0;
+		vector3 e1;
+		vector3 e2;
+		std::uint32_t face;
+	};
+
+	struct bounds
+	{
+		float min[3]{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		float max[3]{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+		void grow(const float* lo, const float* hi)
+		{
+			for (std::size_t i = 0; i < 3; i++)
+			{
+				min[i] = std::min(min[i], lo[i]);
+				max[i] = std::max(max[i], hi[i]);
+			}
+		}
+
+		void grow(const bounds& other)
+		{
+			grow(other.min, other.max);
+		}
+
+		float area() const
+		{
+			const auto x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+			return x < 0.0f ? 0.0f : 2.0f * (x * y + y * z + z * x);
+		}
+	};
+
+	std::vector<node> nodes;
+	std::vector<triangle> triangles;
+
+	// per triangle build inputs
+	struct build_state
+	{
+		std::vector<bounds> boxes;
+		std::vector<std::array<float, 3>> centroids;
+		std::vector<std::uint32_t> refs;
+	};
+
+	static lod_bvh build(const mlod_lod& lod)
+	{
+		lod_bvh out;
+		std::vector<triangle> source;
+
+		for (std::uint32_t f = 0; f < lod.faces.size(); f++)
+		{
+			const auto& face = lod.faces[f];
+			const auto corners = face.corner_count();
+
+			for (std::uint32_t c = 2; c < corners; c++)
+			{
+				const auto i0 = face.vertices[0].point_index;
+				const auto i1 = face.vertices[c - 1].point_index;
+				const auto i2 = face.vertices[c].point_index;
+
+				if (i0 >= lod.points.size() || i1 >= lod.points.size() || i2 >= lod.points.size())
+					continue;
+
+				const auto& a = lod.points[i0].pos;
+				const auto& b = lod.points[i1].pos;
+				const auto& d = lod.points[i2].pos;
+
+				source.push_back({ a, { b.x - a.x, b.y - a.y, b.z - a.z }, { d.x - a.x, d.y - a.y, d.z - a.z }, f });
+			}
+		}
+
+		const auto count = source.size();
+
+		if (count == 0)
+			return out;
+
+		build_state state;
+		state.boxes.resize(count);
+		state.centroids.resize(count);
+		state.refs.resize(count);
+
+		parallel_for(count, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& tri = source[i];
+				const float p[3][3] = {
+					{ tri.v0.x, tri.v0.y, tri.v0.z },
+					{ tri.v0.x + tri.e1.x, tri.v0.y + tri.e1.y, tri.v0.z + tri.e1.z },
+					{ tri.v0.x + tri.e2.x, tri.v0.y + tri.e2.y, tri.v0.z + tri.e2.z } };
+
+				auto& box = state.boxes[i];
+				box = {};
+
+				for (const auto& corner : p)
+					box.grow(corner, corner);
+
+				for (std::size_t axis = 0; axis < 3; axis++)
+					state.centroids[i][axis] = 0.5f * (box.min[axis] + box.max[axis]);
+
+				state.refs[i] = static_cast<std::uint32_t>(i);
+			}
+		});
+
+		out.nodes = build_parallel(state, 0, static_cast<std::uint32_t>(count), 0);
+
+		// leaves index triangles directly, store them in leaf order
+		out.triangles.resize(count);
+		for (std::size_t i = 0; i < count; i++)
+			out.triangles[i] = source[state.refs[i]];
+
+		return out;
+	}
+
+	// partitions around the middle reference on the widest centroid axis
+	static bool split_median(build_state& state, const std::uint32_t begin, const std::uint32_t end, std::uint32_t& mid, std::uint16_t& split_axis)
+	{
+		const auto count = end - begin;
+
+		if (count <= max_leaf_size)
+			return false;
+
+		bounds centroid_bounds;
+		for (auto i = begin; i < end; i++)
+			centroid_bounds.grow(state.centroids[state.refs[i]].data(), state.centroids[state.refs[i]].data());
+
+		std::uint16_t axis = 0;
+		for (std::uint16_t a = 1; a < 3; a++)
+		{
+			if (centroid_bounds.max[a] - centroid_bounds.min[a] > centroid_bounds.max[axis] - centroid_bounds.min[axis])
+				axis = a;
+		}
+
+		mid = begin + count / 2;
+		split_axis = axis;
+
+		std::nth_element(state.refs.begin() + begin, state.refs.begin() + mid, state.refs.begin() + end, [&](const std::uint32_t a, const std::uint32_t b)
+		{
+			return state.centroids[a][axis] < state.centroids[b][axis];
+		});
+
+		return true;
+	}
+
+	// returns false if a leaf is cheaper
+	static bool split(build_state& state, const std::uint32_t begin, const std::uint32_t end, const std::uint32_t depth, std::uint32_t& mid, std::uint16_t& split_axis)
+	{
+		const auto count = end - begin;
+
+		if (count <= 2)
+			return false;
+
+		if (depth >= max_sah_depth)
+			return split_median(state, begin, end, mid, split_axis);
+
+		bounds centroid_bounds;
+		bounds total;
+
+		for (auto i = begin; i < end; i++)
+		{
+			const auto ref = state.refs[i];
+			centroid_bounds.grow(state.centroids[ref].data(), state.centroids[ref].data());
+			total.grow(state.boxes[ref]);
+		}
+
+		auto best_cost = static_cast<float>(count);
+		auto best_axis = -1;
+		std::uint32_t best_bin = 0;
+
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			const auto lo = centroid_bounds.min[axis];
+			const auto extent = centroid_bounds.max[axis] - lo;
+
+			if (extent <= 0.0f)
+				continue;
+
+			bounds bins[bin_count];
+			std::uint32_t bin_sizes[bin_count]{};
+			const auto scale = bin_count / extent;
+
+			for (auto i = begin; i < end; i++)
+			{
+				const auto ref = state.refs[i];
+				const auto bin = std::min(bin_count - 1, static_cast<std::uint32_t>((state.centroids[ref][axis] - lo) * scale));
+				bins[bin].grow(state.boxes[ref]);
+				bin_sizes[bin]++;
+			}
+
+			// sweep from the right to get the cost of every right side
+			float right_cost[bin_count]{};
+			bounds right;
+			std::uint32_t right_count = 0;
+
+			for (auto b = bin_count - 1; b > 0; b--)
+			{
+				right.grow(bins[b]);
+				right_count += bin_sizes[b];
+				right_cost[b] = right.area() * static_cast<float>(right_count);
+			}
+
+			bounds left;
+			std::uint32_t left_count = 0;
+			const auto inv_area = 1.0f / std::max(total.area(), 1e-30f);
+
+			for (std::uint32_t b = 1; b < bin_count; b++)
+			{
+				left.grow(bins[b - 1]);
+				left_count += bin_sizes[b - 1];
+
+				if (left_count == 0 || left_count == count)
+					continue;
+
+				const auto cost = 1.0f + (left.area() * static_cast<float>(left_count) + right_cost[b]) * inv_area;
+
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = b;
+				}
+			}
+		}
+
+		if (best_axis < 0)
+		{
+			if (count <= max_leaf_size)
+				return false;
+
+			// every centroid coincides, split in the middle to respect the leaf size
+			mid = begin + count / 2;
+			split_axis = 0;
+			return true;
+		}
+
+		if (count <= max_leaf_size && best_cost >= static_cast<float>(count))
+			return false;
+
+		const auto lo = centroid_bounds.min[best_axis];
+		const auto scale = bin_count / (centroid_bounds.max[best_axis] - lo);
+
+		const auto it = std::partition(state.refs.begin() + begin, state.refs.begin() + end, [&](const std::uint32_t ref)
+		{
+			return std::min(bin_count - 1, static_cast<std::uint32_t>((state.centroids[ref][best_axis] - lo) * scale)) < best_bin;
+		});
+
+		mid = static_cast<std::uint32_t>(it - state.refs.begin());
+		split_axis = static_cast<std::uint16_t>(best_axis);
+		return true;
+	}
+
+	static node make_node(const build_state& state, const std::uint32_t begin, const std::uint32_t end)
+	{
+		bounds box;
+		for (auto i = begin; i < end; i++)
+			box.grow(state.boxes[state.refs[i]]);
+
+		node out{};
+		std::copy(box.min, box.min + 3, out.min);
+		std::copy(box.max, box.max + 3, out.max);
+		return out;
+	}
+
+	static std::uint32_t build_serial(build_state& state, std::vector<node>& out, const std::uint32_t begin, const std::uint32_t end, const std::uint32_t depth)
+	{
+		const auto index = static_cast<std::uint32_t>(out.size());
+		out.push_back(make_node(state, begin, end));
+
+		std::uint32_t mid{};
+		std::uint16_t axis{};
+
+		if (!split(state, begin, end, depth, mid, axis))
+		{
+			out[index].offset = begin;
+			out[index].count = static_cast<std::uint16_t>(end - begin);
+			return index;
+		}
+
+		build_serial(state, out, begin, mid, depth + 1);
+		out[index].offset = build_serial(state, out, mid, end, depth + 1);
+		out[index].axis = axis;
+		return index;
+	}
+
+	// forks the left half onto its own thread while the subtree is large enough,
+	// the returned nodes are rooted at index 0
+	static std::vector<node> build_parallel(build_state& state, const std::uint32_t begin, const std::uint32_t end, const std::uint32_t depth)
+	{
+		std::vector<node> out;
+		const auto max_depth = static_cast<std::uint32_t>(std::log2(std::max(1u, std::thread::hardware_concurrency()))) + 1;
+
+		// inside a parallel_for chunk the other chunks already occupy the cores
+		if (end - begin < parallel_grain || depth >= max_depth || in_parallel_region)
+		{
+			out.reserve(2 * (end - begin) / max_leaf_size + 1);
+			build_serial(state, out, begin, end, depth);
+			return out;
+		}
+
+		out.push_back(make_node(state, begin, end));
+
+		std::uint32_t mid{};
+		std::uint16_t axis{};
+
+		if (!split(state, begin, end, depth, mid, axis))
+		{
+			out[0].offset = begin;
+			out[0].count = static_cast<std::uint16_t>(end - begin);
+			return out;
+		}
+
+		std::vector<node> left;
+		std::thread worker([&]() { left = build_parallel(state, begin, mid, depth + 1); });
+		auto right = build_parallel(state, mid, end, depth + 1);
+		worker.join();
+
+		const auto append = [&out](const std::vector<node>& subtree)
+		{
+			const auto base = static_cast<std::uint32_t>(out.size());
+
+			for (auto n : subtree)
+			{
+				if (n.count == 0)
+					n.offset += base;
+				out.push_back(n);
+			}
+		};
+
+		append(left);
+		out[0].offset = static_cast<std::uint32_t>(out.size());
+		out[0].axis = axis;
+		append(right);
+		return out;
+	}
+
+	static bool intersect_box(const node& n, const float* origin, const float* inv_dir, const float t_max)
+	{
+		auto t0 = 0.0f;
+		auto t1 = t_max;
+
+		for (std::size_t axis = 0; axis < 3; axis++)
+		{
+			auto near_t = (n.min[axis] - origin[axis]) * inv_dir[axis];
+			auto far_t = (n.max[axis] - origin[axis]) * inv_dir[axis];
+
+			if (near_t > far_t)
+				std::swap(near_t, far_t);
+
+			// nan from 0 * inf leaves the bound untouched
+			t0 = near_t > t0 ? near_t : t0;
+			t1 = far_t < t1 ? far_t : t1;
+		}
+
+		return t0 <= t1;
+	}
+
+	ray_hit intersect(const ray& r) const
+	{
+		ray_hit hit;
+		hit.t = r.t_max;
+
+		if (nodes.empty())
+			return hit;
+
+		const float origin[3] = { r.origin.x, r.origin.y, r.origin.z };
+		const float inv_dir[3] = { 1.0f / r.direction.x, 1.0f / r.direction.y, 1.0f / r.direction.z };
+
+		std::uint32_t stack[stack_capacity];
+		std::uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size != 0)
+		{
+			const auto index = stack[--stack_size];
+			const auto& n = nodes[index];
+
+			if (!intersect_box(n, origin, inv_dir, hit.t))
+				continue;
+
+			if (n.count != 0)
+			{
+				for (auto i = n.offset; i < n.offset + n.count; i++)
+				{
+					const auto& tri = triangles[i];
+
+					const auto px = r.direction.y * tri.e2.z - r.direction.z * tri.e2.y;
+					const auto py = r.direction.z * tri.e2.x - r.direction.x * tri.e2.z;
+					const auto pz = r.direction.x * tri.e2.y - r.direction.y * tri.e2.x;
+					const auto det = tri.e1.x * px + tri.e1.y * py + tri.e1.z * pz;
+
+					if (std::fabs(det) < 1e-12f)
+						continue;
+
+					const auto inv_det = 1.0f / det;
+					const auto sx = r.origin.x - tri.v0.x, sy = r.origin.y - tri.v0.y, sz = r.origin.z - tri.v0.z;
+					const auto u = (sx * px + sy * py + sz * pz) * inv_det;
+
+					if (u < 0.0f || u > 1.0f)
+						continue;
+
+					const auto qx = sy * tri.e1.z - sz * tri.e1.y;
+					const auto qy = sz * tri.e1.x - sx * tri.e1.z;
+					const auto qz = sx * tri.e1.y - sy * tri.e1.x;
+					const auto v = (r.direction.x * qx + r.direction.y * qy + r.direction.z * qz) * inv_det;
+
+					if (v < 0.0f || u + v > 1.0f)
+						continue;
+
+					const auto t = (tri.e2.x * qx + tri.e2.y * qy + tri.e2.z * qz) * inv_det;
+
+					if (t >= 0.0f && t < hit.t)
+						hit = { t, tri.face, u, v };
+				}
+
+				continue;
+			}
+
+			// the left child holds the lower centroids, visit the near child first
+			if (inv_dir[n.axis] >= 0.0f)
+			{
+				stack[stack_size++] = n.offset;
+				stack[stack_size++] = index + 1;
+			}
+			else
+			{
+				stack[stack_size++] = index + 1;
+				stack[stack_size++] = n.offset;
+			}
+		}
+
+		return hit;
+	}
+
+	// traverses 4 rays together, a node is entered while any of them still overlaps
+	// it. pays off for coherent rays such as a grid shot from one viewpoint
+	void intersect4(const ray* rays, ray_hit* hits) const
+	{
+		alignas(16) float lanes[10][4];
+
+		for (std::size_t i = 0; i < 4; i++)
+		{
+			const auto& r = rays[i];
+			lanes[0][i] = r.origin.x;
+			lanes[1][i] = r.origin.y;
+			lanes[2][i] = r.origin.z;
+			lanes[3][i] = r.direction.x;
+			lanes[4][i] = r.direction.y;
+			lanes[5][i] = r.direction.z;
+			lanes[6][i] = 1.0f / r.direction.x;
+			lanes[7][i] = 1.0f / r.direction.y;
+			lanes[8][i] = 1.0f / r.direction.z;
+			lanes[9][i] = r.t_max;
+		}
+
+		const __m128 origin[3] = { _mm_load_ps(lanes[0]), _mm_load_ps(lanes[1]), _mm_load_ps(lanes[2]) };
+		const __m128 dir[3] = { _mm_load_ps(lanes[3]), _mm_load_ps(lanes[4]), _mm_load_ps(lanes[5]) };
+		const __m128 inv_dir[3] = { _mm_load_ps(lanes[6]), _mm_load_ps(lanes[7]), _mm_load_ps(lanes[8]) };
+
+		auto best_t = _mm_load_ps(lanes[9]);
+		auto best_u = _mm_setzero_ps();
+		auto best_v = _mm_setzero_ps();
+		auto best_face = _mm_set1_epi32(-1);
+
+		const auto cross = [](const __m128* a, const __m128* b, __m128* out)
+		{
+			out[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(a[2], b[1]));
+			out[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(a[0], b[2]));
+			out[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(a[1], b[0]));
+		};
+
+		const auto dot = [](const __m128* a, const __m128* b)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+		};
+
+		if (nodes.empty())
+		{
+			for (std::size_t i = 0; i < 4; i++)
+				hits[i] = { rays[i].t_max, ray_hit::none, 0.0f, 0.0f };
+			return;
+		}
+
+		std::uint32_t stack[stack_capacity];
+		std::uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size != 0)
+		{
+			const auto index = stack[--stack_size];
+			const auto& n = nodes[index];
+
+			auto t0 = _mm_setzero_ps();
+			auto t1 = best_t;
+
+			for (std::size_t axis = 0; axis < 3; axis++)
+			{
+				const auto near_t = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.min[axis]), origin[axis]), inv_dir[axis]);
+				const auto far_t = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(n.max[axis]), origin[axis]), inv_dir[axis]);
+
+				// minps/maxps return their second operand when either is nan. the order
+				// here matches intersect_box: an axis ray starting on a slab plane gives
+				// 0 * inf, which leaves that bound untouched instead of culling the lane
+				const auto lo = _mm_min_ps(far_t, near_t);
+				const auto hi = _mm_max_ps(near_t, far_t);
+
+				t0 = _mm_max_ps(lo, t0);
+				t1 = _mm_min_ps(hi, t1);
+			}
+
+			if (_mm_movemask_ps(_mm_cmple_ps(t0, t1)) == 0)
+				continue;
+
+			if (n.count == 0)
+			{
+				if (lanes[6 + n.axis][0] >= 0.0f)
+				{
+					stack[stack_size++] = n.offset;
+					stack[stack_size++] = index + 1;
+				}
+				else
+				{
+					stack[stack_size++] = index + 1;
+					stack[stack_size++] = n.offset;
+				}
+
+				continue;
+			}
+
+			for (auto i = n.offset; i < n.offset + n.count; i++)
+			{
+				const auto& tri = triangles[i];
+				const __m128 e1[3] = { _mm_set1_ps(tri.e1.x), _mm_set1_ps(tri.e1.y), _mm_set1_ps(tri.e1.z) };
+				const __m128 e2[3] = { _mm_set1_ps(tri.e2.x), _mm_set1_ps(tri.e2.y), _mm_set1_ps(tri.e2.z) };
+				const __m128 s_vec[3] = {
+					_mm_sub_ps(origin[0], _mm_set1_ps(tri.v0.x)),
+					_mm_sub_ps(origin[1], _mm_set1_ps(tri.v0.y)),
+					_mm_sub_ps(origin[2], _mm_set1_ps(tri.v0.z)) };
+
+				__m128 p[3], q[3];
+				cross(dir, e2, p);
+				cross(s_vec, e1, q);
+
+				const auto det = dot(e1, p);
+				const auto inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+				const auto u = _mm_mul_ps(dot(s_vec, p), inv_det);
+				const auto v = _mm_mul_ps(dot(dir, q), inv_det);
+				const auto t = _mm_mul_ps(dot(e2, q), inv_det);
+
+				const auto abs_det = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+				auto valid = _mm_cmpge_ps(abs_det, _mm_set1_ps(1e-12f));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(u, _mm_setzero_ps()));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(v, _mm_setzero_ps()));
+				valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+				valid = _mm_and_ps(valid, _mm_cmpge_ps(t, _mm_setzero_ps()));
+				valid = _mm_and_ps(valid, _mm_cmplt_ps(t, best_t));
+
+				if (_mm_movemask_ps(valid) == 0)
+					continue;
+
+				best_t = _mm_or_ps(_mm_and_ps(valid, t), _mm_andnot_ps(valid, best_t));
+				best_u = _mm_or_ps(_mm_and_ps(valid, u), _mm_andnot_ps(valid, best_u));
+				best_v = _mm_or_ps(_mm_and_ps(valid, v), _mm_andnot_ps(valid, best_v));
+
+				const auto valid_i = _mm_castps_si128(valid);
+				best_face = _mm_or_si128(_mm_and_si128(valid_i, _mm_set1_epi32(static_cast<int>(tri.face))), _mm_andnot_si128(valid_i, best_face));
+			}
+		}
+
+		alignas(16) float out_t[4], out_u[4], out_v[4];
+		alignas(16) std::uint32_t out_face[4];
+
+		_mm_store_ps(out_t, best_t);
+		_mm_store_ps(out_u, best_u);
+		_mm_store_ps(out_v, best_v);
+		_mm_store_si128(reinterpret_cast<__m128i*>(out_face), best_face);
+
+		for (std::size_t i = 0; i < 4; i++)
+			hits[i] = { out_t[i], out_face[i], out_u[i], out_v[i] };
+	}
+
+	// batched closest hits, packets of 4 spread across threads
+	std::vector<ray_hit> intersect(const std::vector<ray>& rays) const
+	{
+		std::vector<ray_hit> hits(rays.size());
+		const auto packets = (rays.size() + 3) / 4;
+
+		parallel_for(packets, 1024, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto packet = begin; packet < end; packet++)
+			{
+				const auto first = packet * 4;
+
+				if (first + 4 <= rays.size())
+				{
+					intersect4(rays.data() + first, hits.data() + first);
+					continue;
+				}
+
+				for (auto i = first; i < rays.size(); i++)
+					hits[i] = intersect(rays[i]);
+			}
+		});
+
+		return hits;
+	}
+
+	static float dot(const vector3& a, const vector3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	static vector3 sub(const vector3& a, const vector3& b)
+	{
+		return { a.x - b.x, a.y - b.y, a.z - b.z };
+	}
+
+	static vector3 madd(const vector3& a, const vector3& b, const float s)
+	{
+		return { a.x + b.x * s, a.y + b.y * s, a.z + b.z * s };
+	}
+
+	// Ericson, real-time collision detection 5.1.5
+	static vector3 closest_on_triangle(const vector3& p, const triangle& tri)
+	{
+		const auto& a = tri.v0;
+		const auto& ab = tri.e1;
+		const auto& ac = tri.e2;
+		const auto ap = sub(p, a);
+
+		const auto d1 = dot(ab, ap);
+		const auto d2 = dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+
+		const auto b = madd(a, ab, 1.0f);
+		const auto bp = sub(p, b);
+		const auto d3 = dot(ab, bp);
+		const auto d4 = dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+
+		const auto vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return madd(a, ab, d1 / (d1 - d3));
+
+		const auto c = madd(a, ac, 1.0f);
+		const auto cp = sub(p, c);
+		const auto d5 = dot(ab, cp);
+		const auto d6 = dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+
+		const auto vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return madd(a, ac, d2 / (d2 - d6));
+
+		const auto va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			return madd(b, sub(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const auto denom = 1.0f / (va + vb + vc);
+		return madd(madd(a, ab, vb * denom), ac, vc * denom);
+	}
+
+	static float box_distance_sq(const node& n, const vector3& p)
+	{
+		const float q[3] = { p.x, p.y, p.z };
+		auto dist = 0.0f;
+
+		for (std::size_t axis = 0; axis < 3; axis++)
+		{
+			const auto d = std::max(std::max(n.min[axis] - q[axis], q[axis] - n.max[axis]), 0.0f);
+			dist += d * d;
+		}
+
+		return dist;
+	}
+
+	static bool box_overlap(const node& n, const float* lo, const float* hi)
+	{
+		for (std::size_t axis = 0; axis < 3; axis++)
+		{
+			if (n.min[axis] > hi[axis] || n.max[axis] < lo[axis])
+				return false;
+		}
+
+		return true;
+	}
+
+	// separating axis test of a triangle against an aabb, Akenine-Moller
+	static bool triangle_box_overlap(const triangle& tri, const float* lo, const float* hi)
+	{
+		const vector3 center{ 0.5f * (lo[0] + hi[0]), 0.5f * (lo[1] + hi[1]), 0.5f * (lo[2] + hi[2]) };
+		const float half[3] = { 0.5f * (hi[0] - lo[0]), 0.5f * (hi[1] - lo[1]), 0.5f * (hi[2] - lo[2]) };
+
+		const auto v0 = sub(tri.v0, center);
+		const auto v1 = madd(v0, tri.e1, 1.0f);
+		const auto v2 = madd(v0, tri.e2, 1.0f);
+		const vector3 verts[3] = { v0, v1, v2 };
+		const vector3 edges[3] = { sub(v1, v0), sub(v2, v1), sub(v0, v2) };
+
+		const auto separated = [&](const vector3& axis)
+		{
+			const auto p0 = dot(verts[0], axis), p1 = dot(verts[1], axis), p2 = dot(verts[2], axis);
+			const auto r = half[0] * std::fabs(axis.x) + half[1] * std::fabs(axis.y) + half[2] * std::fabs(axis.z);
+			return std::min({ p0, p1, p2 }) > r || std::max({ p0, p1, p2 }) < -r;
+		};
+
+		// the box's own axes
+		const vector3 box_axes[3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+
+		for (const auto& axis : box_axes)
+		{
+			if (separated(axis))
+				return false;
+		}
+
+		// the triangle's plane
+		const vector3 normal{
+			tri.e1.y * tri.e2.z - tri.e1.z * tri.e2.y,
+			tri.e1.z * tri.e2.x - tri.e1.x * tri.e2.z,
+			tri.e1.x * tri.e2.y - tri.e1.y * tri.e2.x };
+
+		if (separated(normal))
+			return false;
+
+		// edge cross products
+		for (const auto& box_axis : box_axes)
+		{
+			for (const auto& edge : edges)
+			{
+				const vector3 axis{
+					box_axis.y * edge.z - box_axis.z * edge.y,
+					box_axis.z * edge.x - box_axis.x * edge.z,
+					box_axis.x * edge.y - box_axis.y * edge.x };
+
+				if (separated(axis))
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	struct closest_hit
+	{
+		vector3 point{};
+		float distance_sq{ std::numeric_limits<float>::infinity() };
+		std::uint32_t face{ ray_hit::none };
+
+		bool hit() const { return face != ray_hit::none; }
+	};
+
+	// nearest point on the mesh within max_distance
+	closest_hit closest_point(const vector3& p, const float max_distance = std::numeric_limits<float>::infinity()) const
+	{
+		closest_hit best;
+		best.distance_sq = max_distance * max_distance;
+
+		if (nodes.empty())
+			return best;
+
+		std::uint32_t stack[stack_capacity];
+		std::uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size != 0)
+		{
+			const auto index = stack[--stack_size];
+			const auto& n = nodes[index];
+
+			if (box_distance_sq(n, p) > best.distance_sq)
+				continue;
+
+			if (n.count == 0)
+			{
+				// push the farther child first so the nearer one tightens the bound sooner
+				const auto left = box_distance_sq(nodes[index + 1], p);
+				const auto right = box_distance_sq(nodes[n.offset], p);
+
+				stack[stack_size++] = left < right ? n.offset : index + 1;
+				stack[stack_size++] = left < right ? index + 1 : n.offset;
+				continue;
+			}
+
+			for (auto i = n.offset; i < n.offset + n.count; i++)
+			{
+				const auto q = closest_on_triangle(p, triangles[i]);
+				const auto d = sub(q, p);
+				const auto dist = dot(d, d);
+
+				if (dist <= best.distance_sq)
+					best = { q, dist, triangles[i].face };
+			}
+		}
+
+		return best;
+	}
+
+	// appends every face within radius of center, sorted and without duplicates
+	void overlap_sphere(const vector3& center, const float radius, std::vector<std::uint32_t>& faces) const
+	{
+		const auto first = faces.size();
+		const auto radius_sq = radius * radius;
+
+		for_each_leaf([&](const node& n) { return box_distance_sq(n, center) <= radius_sq; }, [&](const triangle& tri)
+		{
+			const auto d = sub(closest_on_triangle(center, tri), center);
+
+			if (dot(d, d) <= radius_sq)
+				faces.push_back(tri.face);
+		});
+
+		std::sort(faces.begin() + static_cast<std::ptrdiff_t>(first), faces.end());
+		faces.erase(std::unique(faces.begin() + static_cast<std::ptrdiff_t>(first), faces.end()), faces.end());
+	}
+
+	// appends every face overlapping the box, sorted and without duplicates
+	void overlap_aabb(const vector3& min, const vector3& max, std::vector<std::uint32_t>& faces) const
+	{
+		const auto first = faces.size();
+		const float lo[3] = { min.x, min.y, min.z };
+		const float hi[3] = { max.x, max.y, max.z };
+
+		for_each_leaf([&](const node& n) { return box_overlap(n, lo, hi); }, [&](const triangle& tri)
+		{
+			if (triangle_box_overlap(tri, lo, hi))
+				faces.push_back(tri.face);
+		});
+
+		std::sort(faces.begin() + static_cast<std::ptrdiff_t>(first), faces.end());
+		faces.erase(std::unique(faces.begin() + static_cast<std::ptrdiff_t>(first), faces.end()), faces.end());
+	}
+
+	template<typename NodeTest, typename TriangleFn>
+	void for_each_leaf(NodeTest&& node_test, TriangleFn&& fn) const
+	{
+		if (nodes.empty())
+			return;
+
+		std::uint32_t stack[stack_capacity];
+		std::uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size != 0)
+		{
+			const auto index = stack[--stack_size];
+			const auto& n = nodes[index];
+
+			if (!node_test(n))
+				continue;
+
+			if (n.count == 0)
+			{
+				stack[stack_size++] = n.offset;
+				stack[stack_size++] = index + 1;
+				continue;
+			}
+
+			for (auto i = n.offset; i < n.offset + n.count; i++)
+				fn(triangles[i]);
+		}
+	}
+
+	// batched queries, spread across threads
+
+	std::vector<closest_hit> closest_points(const std::vector<vector3>& points, const float max_distance = std::numeric_limits<float>::infinity()) const
+	{
+		std::vector<closest_hit> out(points.size());
+
+		parallel_for(points.size(), 1024, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				out[i] = closest_point(points[i], max_distance);
+		});
+
+		return out;
+	}
+
+	struct sphere
+	{
+		vector3 center;
+		float radius;
+	};
+
+	std::vector<std::vector<std::uint32_t>> overlap_spheres(const std::vector<sphere>& spheres) const
+	{
+		std::vector<std::vector<std::uint32_t>> out(spheres.size());
+
+		parallel_for(spheres.size(), 256, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				overlap_sphere(spheres[i].center, spheres[i].radius, out[i]);
+		});
+
+		return out;
+	}
+
+	std::vector<std::vector<std::uint32_t>> overlap_aabbs(const std::vector<std::array<vector3, 2>>& boxes) const
+	{
+		std::vector<std::vector<std::uint32_t>> out(boxes.size());
+
+		parallel_for(boxes.size(), 256, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				overlap_aabb(boxes[i][0], boxes[i][1], out[i]);
+		});
+
+		return out;
+	}
+};
+
+// labels the connected components of a lod, two faces belong to the same
+// component when they share a point. built on a lock free union-find so faces
+// can be merged from every thread at once
+struct component_labeler
+{
+	static constexpr std::uint32_t none = ~std::uint32_t{ 0 };
+	// faces per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 8192;
+
+	struct result
+	{
+		// none for points no face uses
+		std::vector<std::uint32_t> point_component;
+		std::vector<std::uint32_t> face_component;
+		std::uint32_t count{};
+	};
+
+	static std::uint32_t find(std::vector<std::atomic<std::uint32_t>>& parent, std::uint32_t i)
+	{
+		while (true)
+		{
+			auto p = parent[i].load(std::memory_order_relaxed);
+
+			if (p == i)
+				return i;
+
+			// path halving, losing the race only costs a longer walk later
+			const auto gp = parent[p].load(std::memory_order_relaxed);
+			parent[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+			i = gp;
+		}
+	}
+
+	// roots only ever link to a lower index, so no cycles can form
+	static void unite(std::vector<std::atomic<std::uint32_t>>& parent, std::uint32_t a, std::uint32_t b)
+	{
+		while (true)
+		{
+			a = find(parent, a);
+			b = find(parent, b);
+
+			if (a == b)
+				return;
+
+			if (a < b)
+				std::swap(a, b);
+
+			auto expected = a;
+			if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+				return;
+		}
+	}
+
+	static result run(const mlod_lod& lod)
+	{
+		const auto num_points = static_cast<std::uint32_t>(lod.points.size());
+		std::vector<std::atomic<std::uint32_t>> parent(num_points);
+
+		for (std::uint32_t i = 0; i < num_points; i++)
+			parent[i].store(i, std::memory_order_relaxed);
+
+		parallel_for(lod.faces.size(), parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto f = begin; f < end; f++)
+			{
+				const auto& face = lod.faces[f];
+				const auto first = face.vertices[0].point_index;
+
+				for (std::uint32_t c = 1; c < face.corner_count(); c++)
+				{
+					if (first < num_points && face.vertices[c].point_index < num_points)
+						unite(parent, first, face.vertices[c].point_index);
+				}
+			}
+		});
+
+		result out;
+		out.point_component.assign(num_points, none);
+		out.face_component.assign(lod.faces.size(), none);
+
+		// ids in order of first appearance so labels are stable across runs
+		std::vector<std::uint32_t> root_component(num_points, none);
+
+		for (std::size_t f = 0; f < lod.faces.size(); f++)
+		{
+			const auto first = lod.faces[f].vertices[0].point_index;
+
+			if (first >= num_points)
+				continue;
+
+			auto& id = root_component[find(parent, first)];
+
+			if (id == none)
+				id = out.count++;
+
+			out.face_component[f] = id;
+		}
+
+		parallel_for(num_points, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				out.point_component[i] = root_component[find(parent, static_cast<std::uint32_t>(i))];
+		});
+
+		return out;
+	}
+
+	static std::string selection_name(const std::uint32_t component)
+	{
+		return fmt::format("Component{:02}", component + 1);
+	}
+
+	// replaces the lod's Component01.. selections with the labeled components
+	static void emit_selections(mlod_lod& lod, const result& components)
+	{
+		lod.remove_tags([](const mlod_tag& tag)
+		{
+			const auto& name = tag.tag_name.string;
+
+			return lod_remap::is_selection(tag) && name.size() > 9
+				&& uv_atlas_remapper::to_lower(name.substr(0, 9)) == "component"
+				&& std::all_of(name.begin() + 9, name.end(), [](const char ch) { return std::isdigit(static_cast<unsigned char>(ch)) != 0; });
+		});
+
+		const auto num_points = lod.points.size();
+		std::vector<mlod_tag> selections(components.count);
+
+		for (std::uint32_t i = 0; i < components.count; i++)
+		{
+			selections[i].active = true;
+			selections[i].tag_name.string = selection_name(i);
+			selections[i].data.assign(num_points + lod.faces.size(), 0);
+			selections[i].data_length = static_cast<std::uint32_t>(selections[i].data.size());
+		}
+
+		for (std::size_t i = 0; i < num_points; i++)
+		{
+			if (components.point_component[i] != none)
+				selections[components.point_component[i]].data[i] = 1;
+		}
+
+		for (std::size_t f = 0; f < lod.faces.size(); f++)
+		{
+			if (components.face_component[f] != none)
+				selections[components.face_component[f]].data[num_points + f] = 1;
+		}
+
+		for (auto& selection : selections)
+			lod.add_tag(std::move(selection));
+	}
+};
+
+// signed distance of SoA points to the plane n.p = d
+inline void plane_distances(const float* x, const float* y, const float* z, const std::size_t count,
+	const vector3& n, const float d, float* out)
+{
+	const auto nx = _mm_set1_ps(n.x), ny = _mm_set1_ps(n.y), nz = _mm_set1_ps(n.z), nd = _mm_set1_ps(d);
+	std::size_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const auto dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i), nx), _mm_mul_ps(_mm_loadu_ps(y + i), ny)), _mm_mul_ps(_mm_loadu_ps(z + i), nz));
+		_mm_storeu_ps(out + i, _mm_sub_ps(dist, nd));
+	}
+
+	for (; i < count; i++)
+		out[i] = x[i] * n.x + y[i] * n.y + z[i] * n.z - d;
+}
+
+// 3d quickhull. triangles index the input points and wind clockwise seen from
+// outside like every other face. flat or degenerate input gives an empty hull
+struct convex_hull
+{
+	std::vector<std::array<std::uint32_t, 3>> triangles;
+
+	struct hull_face
+	{
+		std::array<std::uint32_t, 3> v;
+		std::array<std::uint32_t, 3> adj;
+		vector3 n;
+		float d;
+		std::vector<std::uint32_t> outside;
+		std::uint32_t visited;
+		bool alive;
+	};
+
+	struct horizon_edge
+	{
+		std::uint32_t a;
+		std::uint32_t b;
+		std::uint32_t neighbor;
+	};
+
+	struct builder
+	{
+		const std::vector<vector3>& points;
+		float epsilon;
+		std::vector<hull_face> faces;
+		std::vector<horizon_edge> horizon;
+		std::vector<std::uint32_t> visible;
+		std::uint32_t stamp{};
+
+		float distance(const hull_face& face, const std::uint32_t point) const
+		{
+			const auto& p = points[point];
+			return face.n.x * p.x + face.n.y * p.y + face.n.z * p.z - face.d;
+		}
+
+		// outward normal by the right hand rule, the winding is flipped on output
+		std::uint32_t add_face(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c)
+		{
+			const auto& pa = points[a];
+			const auto& pb = points[b];
+			const auto& pc = points[c];
+
+			const vector3 u{ pb.x - pa.x, pb.y - pa.y, pb.z - pa.z };
+			const vector3 v{ pc.x - pa.x, pc.y - pa.y, pc.z - pa.z };
+			vector3 n{ u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x };
+
+			const auto length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			const auto inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+			n = { n.x * inv_length, n.y * inv_length, n.z * inv_length };
+
+			faces.push_back({ { a, b, c }, {}, n, n.x * pa.x + n.y * pa.y + n.z * pa.z, {}, 0, true });
+			return static_cast<std::uint32_t>(faces.size() - 1);
+		}
+
+		std::uint32_t edge_slot(const hull_face& face, const std::uint32_t a, const std::uint32_t b) const
+		{
+			for (std::uint32_t e = 0; e < 3; e++)
+			{
+				if (face.v[e] == a && face.v[(e + 1) % 3] == b)
+					return e;
+			}
+
+			return 3;
+		}
+
+		// collects the ordered horizon of the faces visible from point
+		bool find_horizon(const std::uint32_t face_index, const std::uint32_t entry, const std::uint32_t point)
+		{
+			auto& face = faces[face_index];
+			face.visited = stamp;
+			visible.push_back(face_index);
+
+			for (std::uint32_t i = 0; i < 3; i++)
+			{
+				const auto e = (entry + i) % 3;
+				const auto neighbor = face.adj[e];
+				auto& other = faces[neighbor];
+
+				if (other.visited == stamp)
+					continue;
+
+				const auto a = face.v[e];
+				const auto b = face.v[(e + 1) % 3];
+
+				if (distance(other, point) > epsilon)
+				{
+					const auto back = edge_slot(other, b, a);
+
+					if (back == 3 || !find_horizon(neighbor, (back + 1) % 3, point))
+						return false;
+				}
+				else
+				{
+					horizon.push_back({ a, b, neighbor });
+				}
+			}
+
+			return true;
+		}
+
+		bool run()
+		{
+			const auto count = static_cast<std::uint32_t>(points.size());
+
+			if (count < 4)
+				return false;
+
+			// initial tetrahedron from the extreme points
+			std::uint32_t extremes[6]{};
+
+			for (std::uint32_t i = 1; i < count; i++)
+			{
+				const float p[3] = { points[i].x, points[i].y, points[i].z };
+
+				for (std::uint32_t axis = 0; axis < 3; axis++)
+				{
+					const float lo[3] = { points[extremes[axis * 2]].x, points[extremes[axis * 2]].y, points[extremes[axis * 2]].z };
+					const float hi[3] = { points[extremes[axis * 2 + 1]].x, points[extremes[axis * 2 + 1]].y, points[extremes[axis * 2 + 1]].z };
+
+					if (p[axis] < lo[axis])
+						extremes[axis * 2] = i;
+
+					if (p[axis] > hi[axis])
+						extremes[axis * 2 + 1] = i;
+				}
+			}
+
+			const auto dist_sq = [this](const std::uint32_t a, const std::uint32_t b)
+			{
+				const auto x = points[a].x - points[b].x, y = points[a].y - points[b].y, z = points[a].z - points[b].z;
+				return x * x + y * y + z * z;
+			};
+
+			std::uint32_t i0 = extremes[0], i1 = extremes[1];
+
+			for (std::uint32_t a = 0; a < 6; a++)
+			{
+				for (std::uint32_t b = a + 1; b < 6; b++)
+				{
+					if (dist_sq(extremes[a], extremes[b]) > dist_sq(i0, i1))
+					{
+						i0 = extremes[a];
+						i1 = extremes[b];
+					}
+				}
+			}
+
+			if (dist_sq(i0, i1) <= epsilon * epsilon)
+				return false;
+
+			const vector3 line{ points[i1].x - points[i0].x, points[i1].y - points[i0].y, points[i1].z - points[i0].z };
+			std::uint32_t i2 = 0;
+			auto best = 0.0f;
+
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				const vector3 w{ points[i].x - points[i0].x, points[i].y - points[i0].y, points[i].z - points[i0].z };
+				const vector3 c{ w.y * line.z - w.z * line.y, w.z * line.x - w.x * line.z, w.x * line.y - w.y * line.x };
+				const auto d = c.x * c.x + c.y * c.y + c.z * c.z;
+
+				if (d > best)
+				{
+					best = d;
+					i2 = i;
+				}
+			}
+
+			if (best <= epsilon * epsilon * (line.x * line.x + line.y * line.y + line.z * line.z))
+				return false;
+
+			const auto& p0 = points[i0];
+			const vector3 u{ points[i1].x - p0.x, points[i1].y - p0.y, points[i1].z - p0.z };
+			const vector3 v{ points[i2].x - p0.x, points[i2].y - p0.y, points[i2].z - p0.z };
+			const vector3 n{ u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x };
+			const auto n_length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+			std::uint32_t i3 = 0;
+			auto apex_dist = 0.0f;
+
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				const auto d = (n.x * (points[i].x - p0.x) + n.y * (points[i].y - p0.y) + n.z * (points[i].z - p0.z)) / n_length;
+
+				if (std::fabs(d) > std::fabs(apex_dist))
+				{
+					apex_dist = d;
+					i3 = i;
+				}
+			}
+
+			if (std::fabs(apex_dist) <= epsilon)
+				return false;
+
+			// the apex must sit behind the base
+			if (apex_dist > 0.0f)
+				std::swap(i1, i2);
+
+			add_face(i0, i1, i2);
+			add_face(i0, i3, i1);
+			add_face(i1, i3, i2);
+			add_face(i2, i3, i0);
+
+			for (auto& face : faces)
+			{
+				for (std::uint32_t e = 0; e < 3; e++)
+				{
+					for (std::uint32_t other = 0; other < faces.size(); other++)
+					{
+						if (edge_slot(faces[other], face.v[(e + 1) % 3], face.v[e]) != 3)
+							face.adj[e] = other;
+					}
+				}
+			}
+
+			// bucket every point into the face it's farthest in front of
+			aligned_vector<float> x(count), y(count), z(count), dist(count), best_dist(count, epsilon);
+			std::vector<std::uint32_t> best_face(count, ~std::uint32_t{ 0 });
+
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				x[i] = points[i].x;
+				y[i] = points[i].y;
+				z[i] = points[i].z;
+			}
+
+			for (std::uint32_t f = 0; f < 4; f++)
+			{
+				plane_distances(x.data(), y.data(), z.data(), count, faces[f].n, faces[f].d, dist.data());
+
+				for (std::uint32_t i = 0; i < count; i++)
+				{
+					if (dist[i] > best_dist[i])
+					{
+						best_dist[i] = dist[i];
+						best_face[i] = f;
+					}
+				}
+			}
+
+			for (std::uint32_t i = 0; i < count; i++)
+			{
+				if (best_face[i] != ~std::uint32_t{ 0 } && i != i0 && i != i1 && i != i2 && i != i3)
+					faces[best_face[i]].outside.push_back(i);
+			}
+
+			std::vector<std::uint32_t> pending{ 0, 1, 2, 3 };
+
+			while (!pending.empty())
+			{
+				const auto face_index = pending.back();
+				pending.pop_back();
+
+				if (!faces[face_index].alive || faces[face_index].outside.empty())
+					continue;
+
+				// farthest outside point of this face
+				auto apex = faces[face_index].outside[0];
+				for (const auto candidate : faces[face_index].outside)
+				{
+					if (distance(faces[face_index], candidate) > distance(faces[face_index], apex))
+						apex = candidate;
+				}
+
+				stamp++;
+				horizon.clear();
+				visible.clear();
+
+				if (!find_horizon(face_index, 0, apex))
+					return false;
+
+				const auto first_new = static_cast<std::uint32_t>(faces.size());
+				const auto horizon_size = static_cast<std::uint32_t>(horizon.size());
+
+				for (std::uint32_t h = 0; h < horizon_size; h++)
+				{
+					if (horizon[h].b != horizon[(h + 1) % horizon_size].a)
+						return false;
+
+					const auto edge = horizon[h];
+					const auto created = add_face(edge.a, edge.b, apex);
+
+					faces[created].adj = { edge.neighbor, first_new + (h + 1) % horizon_size, first_new + (h + horizon_size - 1) % horizon_size };
+
+					const auto back = edge_slot(faces[edge.neighbor], edge.b, edge.a);
+					if (back == 3)
+						return false;
+
+					faces[edge.neighbor].adj[back] = created;
+				}
+
+				// hand the orphaned outside points over to the new faces
+				for (const auto old : visible)
+				{
+					auto& face = faces[old];
+					face.alive = false;
+
+					for (const auto point : face.outside)
+					{
+						if (point == apex)
+							continue;
+
+						auto best_new = ~std::uint32_t{ 0 };
+						auto best_new_dist = epsilon;
+
+						for (auto f = first_new; f < faces.size(); f++)
+						{
+							const auto d = distance(faces[f], point);
+
+							if (d > best_new_dist)
+							{
+								best_new_dist = d;
+								best_new = f;
+							}
+						}
+
+						if (best_new != ~std::uint32_t{ 0 })
+							faces[best_new].outside.push_back(point);
+					}
+
+					face.outside.clear();
+					face.outside.shrink_to_fit();
+				}
+
+				for (auto f = first_new; f < faces.size(); f++)
+					pending.push_back(f);
+			}
+
+			return true;
+		}
+	};
+
+	// epsilon < 0 picks one relative to the size of the input
+	static convex_hull build(const std::vector<vector3>& points, float epsilon = -1.0f)
+	{
+		convex_hull out;
+
+		if (epsilon < 0.0f)
+		{
+			auto extent = 0.0f;
+
+			for (const auto& p : points)
+				extent = std::max({ extent, std::fabs(p.x), std::fabs(p.y), std::fabs(p.z) });
+
+			epsilon = std::max(extent * 1e-5f, 1e-7f);
+		}
+
+		builder hull{ points, epsilon, {}, {}, {} };
+
+		if (!hull.run())
+			return out;
+
+		for (const auto& face : hull.faces)
+		{
+			if (face.alive)
+				out.triangles.push_back({ face.v[0], face.v[2], face.v[1] });
+		}
+
+		return out;
+	}
+};
+
+struct convexity_report
+{
+	std::uint32_t components{};
+	// component ids as labeled by component_labeler, before any replacement
+	std::vector<std::uint32_t> non_convex;
+	std::uint32_t replaced{};
+};
+
+// geometry style lods must be built from convex components. checks every
+// component in parallel and optionally swaps non convex ones for their hull
+struct convexity_checker
+{
+	// lods whose components the engine treats as convex collision volumes
+	static bool is_collision_lod(const float resolution)
+	{
+		switch (classify_lod(resolution))
+		{
+		case lod_kind::geometry:
+		case lod_kind::geometry_buoyancy:
+		case lod_kind::geometry_physx_old:
+		case lod_kind::geometry_physx:
+		case lod_kind::view_geometry:
+		case lod_kind::fire_geometry:
+		case lod_kind::view_cargo_geometry:
+		case lod_kind::view_cargo_fire_geometry:
+		case lod_kind::view_commander_geometry:
+		case lod_kind::view_commander_fire_geometry:
+		case lod_kind::view_pilot_geometry:
+		case lod_kind::view_pilot_fire_geometry:
+		case lod_kind::view_gunner_geometry:
+		case lod_kind::view_gunner_fire_geometry:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	struct component_points
+	{
+		std::vector<std::uint32_t> faces;
+		std::vector<std::uint32_t> points;
+	};
+
+	static bool is_convex(const mlod_lod& lod, const component_points& component, const float epsilon)
+	{
+		const auto count = component.points.size();
+
+		if (count < 4)
+			return true;
+
+		aligned_vector<float> x(count), y(count), z(count), dist(count);
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const auto& p = lod.points[component.points[i]].pos;
+			x[i] = p.x;
+			y[i] = p.y;
+			z[i] = p.z;
+		}
+
+		for (const auto f : component.faces)
+		{
+			const auto& face = lod.faces[f];
+			const auto corners = face.corner_count();
+
+			// faces join a component by their first corner, the others may be out of range
+			auto valid = true;
+			for (std::uint32_t c = 0; c < corners; c++)
+				valid &= face.vertices[c].point_index < lod.points.size();
+
+			if (!valid)
+				continue;
+
+			// newell normal, robust for slightly warped quads
+			vector3 n{};
+			vector3 centroid{};
+
+			for (std::uint32_t c = 0; c < corners; c++)
+			{
+				const auto& a = lod.points[face.vertices[c].point_index].pos;
+				const auto& b = lod.points[face.vertices[(c + 1) % corners].point_index].pos;
+
+				n.x += (a.y - b.y) * (a.z + b.z);
+				n.y += (a.z - b.z) * (a.x + b.x);
+				n.z += (a.x - b.x) * (a.y + b.y);
+				centroid = { centroid.x + a.x, centroid.y + a.y, centroid.z + a.z };
+			}
+
+			const auto length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+			if (length <= 0.0f)
+				continue;
+
+			n = { n.x / length, n.y / length, n.z / length };
+			const auto d = (n.x * centroid.x + n.y * centroid.y + n.z * centroid.z) / static_cast<float>(corners);
+
+			plane_distances(x.data(), y.data(), z.data(), count, n, d, dist.data());
+
+			const auto [lo, hi] = std::minmax_element(dist.begin(), dist.end());
+
+			// winding independent, every point has to sit on one side of each face
+			if (*lo < -epsilon && *hi > epsilon)
+				return false;
+		}
+
+		return true;
+	}
+
+	static convexity_report run(mlod_lod& lod, const bool replace, const float epsilon = 1e-3f)
+	{
+		convexity_report report;
+		const auto labels = component_labeler::run(lod);
+		report.components = labels.count;
+
+		std::vector<component_points> components(labels.count);
+
+		for (std::uint32_t f = 0; f < lod.faces.size(); f++)
+		{
+			if (labels.face_component[f] != component_labeler::none)
+				components[labels.face_component[f]].faces.push_back(f);
+		}
+
+		for (std::uint32_t i = 0; i < lod.points.size(); i++)
+		{
+			if (labels.point_component[i] != component_labeler::none)
+				components[labels.point_component[i]].points.push_back(i);
+		}
+
+		std::vector<std::uint8_t> convex(labels.count);
+		std::vector<convex_hull> hulls(labels.count);
+
+		parallel_for(labels.count, 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto c = begin; c < end; c++)
+			{
+				convex[c] = is_convex(lod, components[c], epsilon);
+
+				if (convex[c] || !replace)
+					continue;
+
+				std::vector<vector3> positions;
+				positions.reserve(components[c].points.size());
+
+				for (const auto i : components[c].points)
+					positions.push_back(lod.points[i].pos);
+
+				hulls[c] = convex_hull::build(positions);
+			}
+		});
+
+		for (std::uint32_t c = 0; c < labels.count; c++)
+		{
+			if (!convex[c])
+				report.non_convex.push_back(c);
+		}
+
+		if (!replace)
+			return report;
+
+		std::vector<std::uint32_t> face_map(lod.faces.size());
+		std::uint32_t kept = 0;
+		std::vector<mlod_face> added;
+
+		for (std::uint32_t f = 0; f < lod.faces.size(); f++)
+		{
+			const auto c = labels.face_component[f];
+			face_map[f] = c != component_labeler::none && !convex[c] && !hulls[c].triangles.empty() ? lod_remap::removed : kept++;
+		}
+
+		for (const auto c : report.non_convex)
+		{
+			if (hulls[c].triangles.empty())
+				continue;
+
+			for (const auto& tri : hulls[c].triangles)
+			{
+				mlod_face face{};
+				face.face_type = 3;
+				face.vertices.resize(4);
+
+				const auto& a = lod.points[components[c].points[tri[0]]].pos;
+				const auto& b = lod.points[components[c].points[tri[1]]].pos;
+				const auto& d = lod.points[components[c].points[tri[2]]].pos;
+
+				// clockwise winding, outward normal is (d - a) x (b - a)
+				const vector3 u{ d.x - a.x, d.y - a.y, d.z - a.z };
+				const vector3 v{ b.x - a.x, b.y - a.y, b.z - a.z };
+				vector3 n{ u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x };
+				const auto length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+				n = length > 0.0f ? vector3{ n.x / length, n.y / length, n.z / length } : vector3{ 0.0f, 1.0f, 0.0f };
+
+				const auto normal_index = static_cast<std::uint32_t>(lod.normals.size());
+				lod.normals.push_back(n);
+
+				for (std::uint32_t corner = 0; corner < 3; corner++)
+					face.vertices[corner] = { components[c].points[tri[corner]], normal_index, 0.0f, 0.0f };
+
+				added.push_back(std::move(face));
+			}
+
+			report.replaced++;
+		}
+
+		lod.num_face_normals = static_cast<std::uint32_t>(lod.normals.size());
+
+		if (kept != lod.faces.size())
+			lod_remap::remap_faces(lod, face_map, kept);
+
+		lod_remap::append_faces(lod, std::move(added));
+		return report;
+	}
+
+	// every collision lod of every model, models in parallel
+	static std::vector<std::vector<convexity_report>> run(const std::vector<mlod_p3d*>& models, const bool replace, const float epsilon = 1e-3f)
+	{
+		std::vector<std::vector<convexity_report>> reports(models.size());
+
+		parallel_for(models.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto m = begin; m < end; m++)
+			{
+				for (auto& lod : models[m]->lods)
+				{
+					if (is_collision_lod(lod.resolution))
+						reports[m].push_back(run(lod, replace, epsilon));
+				}
+			}
+		});
+
+		return reports;
+	}
+};
+
+// edge adjacency of a lod's faces. every face corner contributes the half edge
+// to the next corner, sorting them by their undirected key groups each edge's
+// half edges together
+struct edge_adjacency
+{
+	static constexpr std::uint32_t none = ~std::uint32_t{ 0 };
+	// faces per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 16384;
+
+	struct half_edge
+	{
+		std::uint32_t from;
+		std::uint32_t to;
+		std::uint32_t face;
+		std::uint32_t corner;
+
+		std::uint64_t key() const { return sharp_edges_tag::key(from, to); }
+	};
+
+	// a run of half edges sharing the same two points
+	struct edge
+	{
+		std::uint32_t first;
+		std::uint32_t count;
+	};
+
+	std::vector<half_edge> half_edges;
+	std::vector<edge> edges;
+	// opposite half edge of a manifold edge, none on boundaries and non manifold edges
+	std::vector<std::uint32_t> twins;
+	// half edge leaving each face corner, indexed face * 4 + corner
+	std::vector<std::uint32_t> corner_half_edges;
+
+	static edge_adjacency build(const mlod_lod& lod)
+	{
+		edge_adjacency out;
+		const auto num_faces = lod.faces.size();
+
+		std::vector<std::uint32_t> offsets(num_faces + 1);
+		for (std::size_t f = 0; f < num_faces; f++)
+			offsets[f + 1] = offsets[f] + lod.faces[f].corner_count();
+
+		out.half_edges.resize(offsets.back());
+		out.corner_half_edges.assign(num_faces * 4, none);
+
+		parallel_for(num_faces, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto f = begin; f < end; f++)
+			{
+				const auto& face = lod.faces[f];
+				const auto n = face.corner_count();
+
+				for (std::uint32_t c = 0; c < n; c++)
+				{
+					out.half_edges[offsets[f] + c] = {
+						face.vertices[c].point_index,
+						face.vertices[(c + 1) % n].point_index,
+						static_cast<std::uint32_t>(f),
+						c };
+				}
+			}
+		});
+
+		parallel_sort(out.half_edges.begin(), out.half_edges.end(), [](const half_edge& l, const half_edge& r)
+		{
+			const auto lk = l.key(), rk = r.key();
+			return lk != rk ? lk < rk : (l.face != r.face ? l.face < r.face : l.corner < r.corner);
+		});
+
+		const auto count = static_cast<std::uint32_t>(out.half_edges.size());
+		out.twins.assign(count, none);
+
+		for (std::uint32_t i = 0, next = 0; i < count; i = next)
+		{
+			const auto key = out.half_edges[i].key();
+
+			next = i + 1;
+			while (next < count && out.half_edges[next].key() == key)
+				next++;
+
+			out.edges.push_back({ i, next - i });
+
+			if (next - i == 2 && out.half_edges[i].from == out.half_edges[i + 1].to && out.half_edges[i].from != out.half_edges[i].to)
+			{
+				out.twins[i] = i + 1;
+				out.twins[i + 1] = i;
+			}
+		}
+
+		parallel_for(count, parallel_grain * 4, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& he = out.half_edges[i];
+				out.corner_half_edges[he.face * 4 + he.corner] = static_cast<std::uint32_t>(i);
+			}
+		});
+
+		return out;
+	}
+
+	// face across the edge leaving the given corner, none if there isn't exactly one
+	std::uint32_t neighbor(const std::uint32_t face, const std::uint32_t corner) const
+	{
+		const auto he = corner_half_edges[face * 4 + corner];
+		return he == none || twins[he] == none ? none : half_edges[twins[he]].face;
+	}
+
+	// edges used by a single face
+	std::vector<std::uint32_t> boundary_edges() const
+	{
+		std::vector<std::uint32_t> out;
+
+		for (std::uint32_t e = 0; e < edges.size(); e++)
+		{
+			if (edges[e].count == 1 && !is_collapsed(e))
+				out.push_back(e);
+		}
+
+		return out;
+	}
+
+	// edges shared by more than two faces, or by two faces running the same way
+	std::vector<std::uint32_t> non_manifold_edges() const
+	{
+		std::vector<std::uint32_t> out;
+
+		for (std::uint32_t e = 0; e < edges.size(); e++)
+		{
+			if (!is_collapsed(e) && (edges[e].count > 2 || (edges[e].count == 2 && twins[edges[e].first] == none)))
+				out.push_back(e);
+		}
+
+		return out;
+	}
+
+	// edges joining a point to itself or two points closer than epsilon
+	std::vector<std::uint32_t> degenerate_edges(const mlod_lod& lod, const float epsilon = 0.0f) const
+	{
+		std::vector<std::uint32_t> out;
+
+		for (std::uint32_t e = 0; e < edges.size(); e++)
+		{
+			const auto& he = half_edges[edges[e].first];
+
+			if (he.from == he.to || he.from >= lod.points.size() || he.to >= lod.points.size())
+			{
+				out.push_back(e);
+				continue;
+			}
+
+			const auto& a = lod.points[he.from].pos;
+			const auto& b = lod.points[he.to].pos;
+			const auto x = a.x - b.x, y = a.y - b.y, z = a.z - b.z;
+
+			if (x * x + y * y + z * z <= epsilon * epsilon)
+				out.push_back(e);
+		}
+
+		return out;
+	}
+
+	bool is_collapsed(const std::uint32_t e) const
+	{
+		const auto& he = half_edges[edges[e].first];
+		return he.from == he.to;
+	}
+};
+
+struct shadow_volume_report
+{
+	std::uint32_t lod_index{};
+	float resolution{};
+	// point index pairs
+	std::vector<std::array<std::uint32_t, 2>> open_edges;
+	std::vector<std::array<std::uint32_t, 2>> non_manifold_edges;
+	// a point sitting on the inside of an open edge it isn't part of
+	struct t_junction
+	{
+		std::uint32_t point;
+		std::array<std::uint32_t, 2> edge;
+	};
+	std::vector<t_junction> t_junctions;
+
+	bool valid() const
+	{
+		return open_edges.empty() && non_manifold_edges.empty() && t_junctions.empty();
+	}
+};
+
+// shadow volume lods have to be closed, manifold meshes. checks every shadow
+// volume lod of a model for open edges, non manifold edges and t-junctions
+struct shadow_volume_validator
+{
+	// stencil shadow resolutions, plus the view-specific shadow volumes
+	static bool is_shadow_volume(const float resolution)
+	{
+		const auto kind = classify_lod(resolution);
+
+		return kind == lod_kind::shadow_volume
+			|| kind == lod_kind::shadow_volume_view_cargo
+			|| kind == lod_kind::shadow_volume_view_pilot
+			|| kind == lod_kind::shadow_volume_view_gunner;
+	}
+
+	static shadow_volume_report validate(const mlod_lod& lod, const float epsilon = 1e-4f)
+	{
+		shadow_volume_report report;
+		report.resolution = lod.resolution;
+
+		const auto adjacency = edge_adjacency::build(lod);
+		const auto endpoints = [&adjacency](const std::uint32_t e) -> std::array<std::uint32_t, 2>
+		{
+			const auto& he = adjacency.half_edges[adjacency.edges[e].first];
+			return { he.from, he.to };
+		};
+
+		for (const auto e : adjacency.boundary_edges())
+			report.open_edges.push_back(endpoints(e));
+
+		for (const auto e : adjacency.non_manifold_edges())
+			report.non_manifold_edges.push_back(endpoints(e));
+
+		if (report.open_edges.empty())
+			return report;
+
+		// t-junctions only show up along open edges, test the open edge endpoints
+		// against every open edge using a sweep along x
+		std::vector<std::uint32_t> candidates;
+
+		for (const auto& edge : report.open_edges)
+		{
+			candidates.push_back(edge[0]);
+			candidates.push_back(edge[1]);
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&lod](const std::uint32_t i) { return i >= lod.points.size(); }), candidates.end());
+
+		std::sort(candidates.begin(), candidates.end(), [&lod](const std::uint32_t l, const std::uint32_t r)
+		{
+			return lod.points[l].pos.x < lod.points[r].pos.x;
+		});
+
+		std::vector<float> xs(candidates.size());
+		for (std::size_t i = 0; i < candidates.size(); i++)
+			xs[i] = lod.points[candidates[i]].pos.x;
+
+		for (const auto& edge : report.open_edges)
+		{
+			if (edge[0] >= lod.points.size() || edge[1] >= lod.points.size())
+				continue;
+
+			const auto& a = lod.points[edge[0]].pos;
+			const auto& b = lod.points[edge[1]].pos;
+			const vector3 ab{ b.x - a.x, b.y - a.y, b.z - a.z };
+			const auto length_sq = ab.x * ab.x + ab.y * ab.y + ab.z * ab.z;
+
+			if (length_sq <= epsilon * epsilon)
+				continue;
+
+			const auto lo = std::lower_bound(xs.begin(), xs.end(), std::min(a.x, b.x) - epsilon) - xs.begin();
+			const auto hi = std::upper_bound(xs.begin(), xs.end(), std::max(a.x, b.x) + epsilon) - xs.begin();
+
+			for (auto i = lo; i < hi; i++)
+			{
+				const auto point = candidates[i];
+
+				if (point == edge[0] || point == edge[1])
+					continue;
+
+				const auto& p = lod.points[point].pos;
+				const vector3 ap{ p.x - a.x, p.y - a.y, p.z - a.z };
+				const auto t = (ap.x * ab.x + ap.y * ab.y + ap.z * ab.z) / length_sq;
+
+				if (t <= 0.0f || t >= 1.0f)
+					continue;
+
+				const vector3 off{ ap.x - ab.x * t, ap.y - ab.y * t, ap.z - ab.z * t };
+
+				// strictly inside, points coinciding with an endpoint are unwelded seams not t-junctions
+				const auto along = std::sqrt(length_sq);
+				if (off.x * off.x + off.y * off.y + off.z * off.z <= epsilon * epsilon && t * along > epsilon && (1.0f - t) * along > epsilon)
+					report.t_junctions.push_back({ point, edge });
+			}
+		}
+
+		return report;
+	}
+
+	// every shadow volume lod of a model, lods in parallel
+	static std::vector<shadow_volume_report> run(const mlod_p3d& p3d, const float epsilon = 1e-4f)
+	{
+		std::vector<std::uint32_t> shadow_lods;
+
+		for (std::uint32_t i = 0; i < p3d.lods.size(); i++)
+		{
+			if (is_shadow_volume(p3d.lods[i].resolution))
+				shadow_lods.push_back(i);
+		}
+
+		std::vector<shadow_volume_report> reports(shadow_lods.size());
+
+		parallel_for(shadow_lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				reports[i] = validate(p3d.lods[shadow_lods[i]], epsilon);
+				reports[i].lod_index = shadow_lods[i];
+			}
+		});
+
+		return reports;
+	}
+
+	// a whole library, models in parallel
+	static std::vector<std::vector<shadow_volume_report>> run(const std::vector<const mlod_p3d*>& models, const float epsilon = 1e-4f)
+	{
+		std::vector<std::vector<shadow_volume_report>> reports(models.size());
+
+		parallel_for(models.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				reports[i] = run(*models[i], epsilon);
+		});
+
+		return reports;
+	}
+};
+
+// one generated lod of a decimation chain
+struct decimation_level
+{
+	float resolution;
+	// fraction of the source triangles to keep
+	float ratio;
+	// quadric error past which collapsing stops even if ratio isn't reached
+	float max_error = std::numeric_limits<float>::infinity();
+};
+
+// quadric error edge collapse. a point is only ever collapsed into one of its
+// neighbours, so surviving points keep their position, flags, selections, mass
+// and #Animation# frames. points on open or non manifold edges, uv seams,
+// texture and material boundaries, sharp edges and selection boundaries are locked
+struct mesh_decimator
+{
+	static constexpr std::uint32_t none = ~std::uint32_t{ 0 };
+	// collapses turning a neighbouring face further than this are rejected
+	static constexpr float min_normal_cos = 0.5f;
+
+	// symmetric 4x4 plane matrix, upper triangle row by row
+	struct quadric
+	{
+		double q[10]{};
+
+		void add_plane(const double a, const double b, const double c, const double d, const double weight)
+		{
+			q[0] += weight * a * a; q[1] += weight * a * b; q[2] += weight * a * c; q[3] += weight * a * d;
+			q[4] += weight * b * b; q[5] += weight * b * c; q[6] += weight * b * d;
+			q[7] += weight * c * c; q[8] += weight * c * d;
+			q[9] += weight * d * d;
+		}
+
+		void add(const quadric& other)
+		{
+			for (auto i = 0; i < 10; i++)
+				q[i] += other.q[i];
+		}
+
+		double error(const vector3& p) const
+		{
+			const double x = p.x, y = p.y, z = p.z;
+
+			return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+				+ q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+				+ q[7] * z * z + 2.0 * q[8] * z
+				+ q[9];
+		}
+	};
+
+	struct candidate
+	{
+		double cost;
+		std::uint32_t from;
+		std::uint32_t to;
+		std::uint32_t from_stamp;
+		std::uint32_t to_stamp;
+
+		// std::priority_queue pops the largest, invert to pop the cheapest
+		bool operator<(const candidate& other) const { return cost > other.cost; }
+	};
+
+	static vector3 triangle_normal(const vector3& a, const vector3& b, const vector3& c)
+	{
+		const vector3 ab{ b.x - a.x, b.y - a.y, b.z - a.z };
+		const vector3 ac{ c.x - a.x, c.y - a.y, c.z - a.z };
+
+		return { ac.y * ab.z - ac.z * ab.y, ac.z * ab.x - ac.x * ab.z, ac.x * ab.y - ac.y * ab.x };
+	}
+
+	// triangles after splitting quads, what ratios are measured against
+	static std::uint32_t triangle_count(const mlod_lod& lod)
+	{
+		std::uint32_t count = 0;
+
+		for (const auto& face : lod.faces)
+			count += face.corner_count() - 2;
+
+		return count;
+	}
+
+	// splits quads and collapses edges until at most target_faces triangles remain
+	// or the cheapest collapse costs more than max_error, then rebuilds normals
+	static void decimate(mlod_lod& lod, const std::uint32_t target_faces, const float max_error = std::numeric_limits<float>::infinity())
+	{
+		lod_remap::split_quads(lod);
+
+		const auto num_points = static_cast<std::uint32_t>(lod.points.size());
+		const auto num_faces = static_cast<std::uint32_t>(lod.faces.size());
+
+		if (num_faces <= target_faces)
+			return;
+
+		std::vector<uv_set_tag*> channels;
+		for (auto& uv_set : lod.uv_sets)
+		{
+			if (uv_set->u.size() == std::size_t{ num_faces } * 3)
+				channels.push_back(&uv_set.edit());
+		}
+
+		std::vector<const mlod_tag*> selections;
+		for (const auto& tag : lod.tags)
+		{
+			if (lod_remap::is_selection(tag) && tag.data.size() == num_points + num_faces)
+				selections.push_back(&tag);
+		}
+
+		std::vector<std::uint8_t> locked(num_points), face_alive(num_faces);
+		std::vector<std::vector<std::uint32_t>> point_faces(num_points);
+		std::vector<quadric> quadrics(num_points);
+
+		const auto lock_edge = [&](const std::uint32_t a, const std::uint32_t b)
+		{
+			if (a < num_points)
+				locked[a] = 1;
+			if (b < num_points)
+				locked[b] = 1;
+		};
+
+		const auto adjacency = edge_adjacency::build(lod);
+
+		for (const auto& edge : adjacency.edges)
+		{
+			const auto& he = adjacency.half_edges[edge.first];
+
+			if (edge.count != 2 || adjacency.twins[edge.first] == none)
+			{
+				lock_edge(he.from, he.to);
+				continue;
+			}
+
+			if (he.from >= num_points || he.to >= num_points)
+				continue;
+
+			for (const auto* tag : selections)
+			{
+				if (tag->data[he.from] != tag->data[he.to])
+					lock_edge(he.from, he.to);
+			}
+		}
+
+		for (const auto& edge : lod.sharp_edges->edges())
+			lock_edge(edge[0], edge[1]);
+
+		// the first corner seen at every point, any other corner disagreeing on
+		// uvs, texture, material or selection weights locks the point
+		std::vector<std::uint32_t> first_corner(num_points, none);
+		std::uint32_t alive_faces = 0;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			const auto& face = lod.faces[f];
+			const auto a = face.vertices[0].point_index, b = face.vertices[1].point_index, c = face.vertices[2].point_index;
+
+			// faces pointing outside the point list are left alone
+			if (a >= num_points || b >= num_points || c >= num_points)
+			{
+				lock_edge(a, b);
+				lock_edge(b, c);
+				continue;
+			}
+
+			face_alive[f] = 1;
+			alive_faces++;
+
+			const auto n = triangle_normal(lod.points[a].pos, lod.points[b].pos, lod.points[c].pos);
+			const auto length = std::sqrt(double{ n.x } * n.x + double{ n.y } * n.y + double{ n.z } * n.z);
+
+			for (std::uint32_t corner = 0; corner < 3; corner++)
+			{
+				const auto point = face.vertices[corner].point_index;
+				point_faces[point].push_back(f);
+
+				if (length > 0.0)
+				{
+					const auto& p = lod.points[point].pos;
+					const auto nx = n.x / length, ny = n.y / length, nz = n.z / length;
+					quadrics[point].add_plane(nx, ny, nz, -(nx * p.x + ny * p.y + nz * p.z), length * 0.5);
+				}
+
+				auto& first = first_corner[point];
+
+				if (first == none)
+				{
+					first = f * 3 + corner;
+					continue;
+				}
+
+				const auto& first_face = lod.faces[first / 3];
+				const auto& first_desc = first_face.vertices[first % 3];
+				auto differs = first_desc.u != face.vertices[corner].u || first_desc.v != face.vertices[corner].v
+					|| first_face.texture_name.string != face.texture_name.string
+					|| first_face.material_name.string != face.material_name.string;
+
+				for (const auto* channel : channels)
+					differs |= channel->u[first] != channel->u[f * 3 + corner] || channel->v[first] != channel->v[f * 3 + corner];
+
+				for (const auto* tag : selections)
+					differs |= tag->data[num_points + first / 3] != tag->data[num_points + f];
+
+				if (differs)
+					locked[point] = 1;
+			}
+		}
+
+		std::vector<std::uint8_t> point_alive(num_points, 1);
+		std::vector<std::uint32_t> stamps(num_points), collapsed_into(num_points, none);
+		std::priority_queue<candidate> queue;
+
+		const auto push = [&](const std::uint32_t from, const std::uint32_t to)
+		{
+			if (locked[from] || lod.points[from].flags != lod.points[to].flags)
+				return;
+
+			auto q = quadrics[from];
+			q.add(quadrics[to]);
+			queue.push({ std::max(q.error(lod.points[to].pos), 0.0), from, to, stamps[from], stamps[to] });
+		};
+
+		for (const auto& edge : adjacency.edges)
+		{
+			const auto& he = adjacency.half_edges[edge.first];
+
+			if (edge.count == 2 && adjacency.twins[edge.first] != none && he.from < num_points && he.to < num_points)
+			{
+				push(he.from, he.to);
+				push(he.to, he.from);
+			}
+		}
+
+		std::vector<std::uint32_t> from_ring, to_ring;
+
+		const auto ring = [&](const std::uint32_t point, std::vector<std::uint32_t>& out)
+		{
+			out.clear();
+
+			for (const auto f : point_faces[point])
+			{
+				for (std::uint32_t c = 0; c < 3; c++)
+				{
+					const auto other = lod.faces[f].vertices[c].point_index;
+					if (other != point)
+						out.push_back(other);
+				}
+			}
+
+			std::sort(out.begin(), out.end());
+			out.erase(std::unique(out.begin(), out.end()), out.end());
+		};
+
+		const auto contains = [&lod](const std::uint32_t f, const std::uint32_t point)
+		{
+			const auto& v = lod.faces[f].vertices;
+			return v[0].point_index == point || v[1].point_index == point || v[2].point_index == point;
+		};
+
+		while (alive_faces > target_faces && !queue.empty())
+		{
+			const auto top = queue.top();
+			queue.pop();
+
+			if (top.cost > max_error)
+				break;
+
+			const auto from = top.from, to = top.to;
+
+			if (!point_alive[from] || !point_alive[to] || stamps[from] != top.from_stamp || stamps[to] != top.to_stamp)
+				continue;
+
+			// link condition, the only points both rings share are the tips of the
+			// faces being removed, otherwise the collapse pinches the surface
+			std::uint32_t shared = 0, shared_face = none;
+
+			for (const auto f : point_faces[from])
+			{
+				if (contains(f, to))
+				{
+					shared++;
+					shared_face = f;
+				}
+			}
+
+			if (shared == 0)
+				continue;
+
+			ring(from, from_ring);
+			ring(to, to_ring);
+
+			std::uint32_t common = 0;
+			for (std::size_t i = 0, j = 0; i < from_ring.size() && j < to_ring.size();)
+			{
+				if (from_ring[i] < to_ring[j])
+					i++;
+				else if (to_ring[j] < from_ring[i])
+					j++;
+				else
+				{
+					common++;
+					i++;
+					j++;
+				}
+			}
+
+			if (common != shared)
+				continue;
+
+			// faces that stay must not flip or degenerate
+			auto valid = true;
+
+			for (const auto f : point_faces[from])
+			{
+				if (contains(f, to))
+					continue;
+
+				const auto& v = lod.faces[f].vertices;
+				const vector3* corners[3];
+				const vector3* moved[3];
+
+				for (std::uint32_t c = 0; c < 3; c++)
+				{
+					corners[c] = &lod.points[v[c].point_index].pos;
+					moved[c] = v[c].point_index == from ? &lod.points[to].pos : corners[c];
+				}
+
+				const auto before = triangle_normal(*corners[0], *corners[1], *corners[2]);
+				const auto after = triangle_normal(*moved[0], *moved[1], *moved[2]);
+				const auto before_sq = before.x * before.x + before.y * before.y + before.z * before.z;
+				const auto after_sq = after.x * after.x + after.y * after.y + after.z * after.z;
+				const auto dot = before.x * after.x + before.y * after.y + before.z * after.z;
+
+				if (after_sq <= before_sq * 1e-8f || dot < min_normal_cos * std::sqrt(before_sq * after_sq))
+				{
+					valid = false;
+					break;
+				}
+			}
+
+			if (!valid)
+				continue;
+
+			// from sits inside a single uv chart, every face it leaves takes to's
+			// uvs from that chart
+			std::uint32_t to_corner = 0;
+			while (lod.faces[shared_face].vertices[to_corner].point_index != to)
+				to_corner++;
+
+			const auto& to_desc = lod.faces[shared_face].vertices[to_corner];
+			const auto to_u = to_desc.u, to_v = to_desc.v;
+
+			for (const auto f : point_faces[from])
+			{
+				if (contains(f, to))
+				{
+					face_alive[f] = 0;
+					alive_faces--;
+					continue;
+				}
+
+				for (std::uint32_t c = 0; c < 3; c++)
+				{
+					auto& desc = lod.faces[f].vertices[c];
+
+					if (desc.point_index != from)
+						continue;
+
+					desc.point_index = to;
+					desc.u = to_u;
+					desc.v = to_v;
+
+					for (auto* channel : channels)
+					{
+						channel->u[f * 3 + c] = channel->u[shared_face * 3 + to_corner];
+						channel->v[f * 3 + c] = channel->v[shared_face * 3 + to_corner];
+					}
+				}
+
+				point_faces[to].push_back(f);
+			}
+
+			auto& to_faces = point_faces[to];
+			to_faces.erase(std::remove_if(to_faces.begin(), to_faces.end(), [&face_alive](const std::uint32_t f) { return !face_alive[f]; }), to_faces.end());
+
+			for (const auto other : from_ring)
+			{
+				if (other == to)
+					continue;
+
+				auto& other_faces = point_faces[other];
+				other_faces.erase(std::remove_if(other_faces.begin(), other_faces.end(), [&face_alive](const std::uint32_t f) { return !face_alive[f]; }), other_faces.end());
+			}
+
+			point_faces[from].clear();
+			quadrics[to].add(quadrics[from]);
+			point_alive[from] = 0;
+			collapsed_into[from] = to;
+			stamps[to]++;
+
+			ring(to, to_ring);
+
+			for (const auto other : to_ring)
+			{
+				push(other, to);
+				push(to, other);
+			}
+		}
+
+		std::vector<std::uint32_t> face_map(num_faces, lod_remap::removed);
+		std::uint32_t kept_faces = 0;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			// faces skipped as invalid are kept as they were
+			const auto& v = lod.faces[f].vertices;
+			const auto skipped = v[0].point_index >= num_points || v[1].point_index >= num_points || v[2].point_index >= num_points;
+
+			if (face_alive[f] || skipped)
+				face_map[f] = kept_faces++;
+		}
+
+		lod_remap::remap_faces(lod, face_map, kept_faces);
+
+		// collapsed points merge into the point they ended up in. remap_points keeps
+		// the lowest old index of a merged group, so they take its data first
+		std::vector<std::uint32_t> point_map(num_points);
+		std::uint32_t kept_points = 0;
+
+		for (std::uint32_t i = 0; i < num_points; i++)
+		{
+			if (point_alive[i])
+				point_map[i] = kept_points++;
+		}
+
+		for (std::uint32_t i = 0; i < num_points; i++)
+		{
+			if (point_alive[i])
+				continue;
+
+			auto target = collapsed_into[i];
+			while (!point_alive[target])
+				target = collapsed_into[target];
+
+			point_map[i] = point_map[target];
+			lod.points[i] = lod.points[target];
+
+			for (auto& frame : lod.animations)
+			{
+				if (frame->x.size() != num_points)
+					continue;
+
+				auto& anim = frame.edit();
+				anim.x[i] = anim.x[target];
+				anim.y[i] = anim.y[target];
+				anim.z[i] = anim.z[target];
+			}
+		}
+
+		if (kept_points != num_points)
+			lod_remap::remap_points(lod, point_map, kept_points);
+
+		normal_generator::run(lod);
+	}
+
+	// decimated copies of lods[source], one per level and built in parallel, are
+	// appended in level order. existing lods keep their indices
+	static void append_chain(mlod_p3d& p3d, const std::uint32_t source, const std::vector<decimation_level>& levels)
+	{
+		if (source >= p3d.lods.size())
+			return;
+
+		const auto source_faces = triangle_count(p3d.lods[source]);
+		std::vector<mlod_lod> generated(levels.size(), p3d.lods[source]);
+
+		parallel_for(levels.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto ratio = std::clamp(levels[i].ratio, 0.0f, 1.0f);
+
+				decimate(generated[i], static_cast<std::uint32_t>(static_cast<double>(source_faces) * ratio), levels[i].max_error);
+				generated[i].resolution = levels[i].resolution;
+			}
+		});
+
+		for (auto& lod : generated)
+			p3d.lods.push_back(std::move(lod));
+
+		p3d.header.lod_count = static_cast<std::uint32_t>(p3d.lods.size());
+		p3d.rebuild_lod_map();
+	}
+};
+
+struct shadow_volume_options
+{
+	float resolution = 1e4f;
+	float weld_epsilon = 1e-3f;
+	// fraction of the welded triangles to keep
+	float ratio = 0.5f;
+	float max_error = std::numeric_limits<float>::infinity();
+	// a lod already at resolution is only overwritten when set
+	bool replace = false;
+};
+
+// builds a closed, simplified shadow volume lod from a visual lod: uvs, textures,
+// point flags and the visual lod's mass, animation, property and proxy tags are
+// stripped, points welded, holes closed with fans, the mesh decimated and every
+// edge marked sharp
+struct shadow_volume_generator
+{
+	static bool is_proxy(const mlod_tag& tag)
+	{
+		return lod_remap::is_selection(tag) && uv_atlas_remapper::to_lower(tag.tag_name.string.substr(0, 6)) == "proxy:";
+	}
+
+	static void strip_surface(mlod_lod& lod)
+	{
+		for (auto& point : lod.points)
+			point.flags = 0;
+
+		for (auto& face : lod.faces)
+		{
+			for (auto& desc : face.vertices)
+			{
+				desc.u = 0.0f;
+				desc.v = 0.0f;
+			}
+
+			face.texture_name.string.clear();
+			face.material_name.string.clear();
+		}
+
+		lod.remove_tags([](const mlod_tag& tag)
+		{
+			const auto& name = tag.tag_name.string;
+			return name == uv_set_tag::name || name == mass_tag::name || name == animation_tag::name || name == property_tag::name || is_proxy(tag);
+		});
+
+		lod.uv_sets.clear();
+		lod.mass = {};
+		lod.animations.clear();
+		lod.properties = {};
+
+		// everything ends up sharp, until then sharp edges would only lock points
+		lod.sharp_edges.edit() = {};
+	}
+
+	// walks the open edges into loops and closes each with a fan, the fan runs
+	// against the loop so it winds the same way as the faces around it. a point
+	// where several holes touch has several open edges leaving it, a walk that
+	// comes back to a point already on its path closes the loop in between
+	static std::uint32_t close_holes(mlod_lod& lod)
+	{
+		const auto adjacency = edge_adjacency::build(lod);
+		const auto open = adjacency.boundary_edges();
+
+		std::unordered_multimap<std::uint32_t, std::uint32_t> outgoing;
+		outgoing.reserve(open.size());
+
+		for (const auto e : open)
+		{
+			const auto& he = adjacency.half_edges[adjacency.edges[e].first];
+			outgoing.emplace(he.from, he.to);
+		}
+
+		std::vector<mlod_face> fans;
+		std::vector<std::uint32_t> path;
+		std::unordered_map<std::uint32_t, std::size_t> on_path;
+		std::uint32_t holes = 0;
+
+		const auto fill = [&](const std::uint32_t* loop, const std::size_t size)
+		{
+			if (size < 3)
+				return;
+
+			for (std::size_t i = 1; i + 1 < size; i++)
+			{
+				mlod_face face{};
+				face.face_type = 3;
+				face.vertices.resize(4);
+				face.vertices[0].point_index = loop[0];
+				face.vertices[1].point_index = loop[i + 1];
+				face.vertices[2].point_index = loop[i];
+				fans.push_back(std::move(face));
+			}
+
+			holes++;
+		};
+
+		while (!outgoing.empty())
+		{
+			auto current = outgoing.begin()->first;
+			path.clear();
+			on_path.clear();
+
+			while (true)
+			{
+				if (const auto seen = on_path.find(current); seen != on_path.end())
+				{
+					const auto first = seen->second;
+					fill(path.data() + first, path.size() - first);
+
+					for (auto i = first; i < path.size(); i++)
+						on_path.erase(path[i]);
+
+					path.resize(first);
+				}
+
+				// open chains that never return are left for the validator to report
+				const auto it = outgoing.find(current);
+				if (it == outgoing.end())
+					break;
+
+				on_path.emplace(current, path.size());
+				path.push_back(current);
+				current = it->second;
+				outgoing.erase(it);
+			}
+		}
+
+		if (!fans.empty())
+			lod_remap::append_faces(lod, std::move(fans));
+
+		return holes;
+	}
+
+	static void mark_all_sharp(mlod_lod& lod)
+	{
+		sharp_edges_tag edges;
+
+		for (const auto& face : lod.faces)
+		{
+			const auto n = face.corner_count();
+
+			for (std::uint32_t c = 0; c < n; c++)
+				edges.insert(face.vertices[c].point_index, face.vertices[(c + 1) % n].point_index);
+		}
+
+		lod.sharp_edges.edit() = std::move(edges);
+	}
+
+	static shadow_volume_report generate(const mlod_lod& visual, mlod_lod& out, const shadow_volume_options& options = {})
+	{
+		out = visual;
+		out.resolution = options.resolution;
+
+		strip_surface(out);
+		lod_pipeline::weld_points(out, options.weld_epsilon);
+		close_holes(out);
+
+		const auto target = static_cast<std::uint32_t>(static_cast<double>(mesh_decimator::triangle_count(out)) * std::clamp(options.ratio, 0.0f, 1.0f));
+		mesh_decimator::decimate(out, target, options.max_error);
+
+		lod_pipeline::compact_lod(out);
+		mark_all_sharp(out);
+		normal_generator::run(out);
+
+		return shadow_volume_validator::validate(out);
+	}
+
+	// generates from the model's first visual lod. a lod already at
+	// options.resolution is an error unless options.replace is set
+	static std::optional<mlod_error> run(mlod_p3d& p3d, shadow_volume_report& report, const shadow_volume_options& options = {})
+	{
+		const auto* visual = p3d.find(lod_kind::visual);
+
+		if (visual == nullptr)
+			return mlod_error("shadow_volume_generator: the model has no visual lod");
+
+		const auto existing = std::find_if(p3d.lods.begin(), p3d.lods.end(), [&options](const mlod_lod& lod)
+		{
+			return lod.resolution == options.resolution;
+		});
+
+		if (existing != p3d.lods.end() && !options.replace)
+			return mlod_error(fmt::format("shadow_volume_generator: the model already has a lod at {}", options.resolution));
+
+		mlod_lod shadow;
+		report = generate(*visual, shadow, options);
+
+		p3d.lods.erase(std::remove_if(p3d.lods.begin(), p3d.lods.end(), [&options](const mlod_lod& lod)
+		{
+			return lod.resolution == options.resolution;
+		}), p3d.lods.end());
+
+		const auto pos = std::upper_bound(p3d.lods.begin(), p3d.lods.end(), options.resolution, [](const float resolution, const mlod_lod& lod)
+		{
+			return resolution < lod.resolution;
+		});
+
+		report.lod_index = static_cast<std::uint32_t>(pos - p3d.lods.begin());
+		p3d.lods.insert(pos, std::move(shadow));
+
+		p3d.header.lod_count = static_cast<std::uint32_t>(p3d.lods.size());
+		p3d.rebuild_lod_map();
+
+		return {};
+	}
+
+	// a whole library, models in parallel. one result per model
+	static std::vector<std::optional<mlod_error>> run(const std::vector<mlod_p3d*>& models, std::vector<shadow_volume_report>& reports, const shadow_volume_options& options = {})
+	{
+		std::vector<std::optional<mlod_error>> results(models.size());
+		reports.assign(models.size(), {});
+
+		parallel_for(models.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				results[i] = run(*models[i], reports[i], options);
+		});
+
+		return results;
+	}
+};
+
+struct face_cleanup_report
+{
+	std::uint32_t degenerate{};
+	std::uint32_t duplicate{};
+};
+
+// drops faces with fewer than three distinct points or (near) zero area, and
+// faces repeating another face's points in any rotation. reversed faces are
+// kept, they're the back side. the first of a set of duplicates survives and
+// takes the strongest selection weight of the set
+struct face_cleanup
+{
+	// faces per thread before parallelizing
+	static constexpr std::size_t parallel_grain = 16384;
+
+	// selection weight bytes aren't ordered by strength: 0 is unselected, 1 is full
+	// weight and 2..255 are decreasing fractions of it
+	static constexpr std::uint32_t weight_rank(const std::uint8_t weight)
+	{
+		return weight == 0 ? 0 : weight == 1 ? 256 : 256u - weight;
+	}
+
+	static constexpr std::uint8_t stronger_weight(const std::uint8_t a, const std::uint8_t b)
+	{
+		return weight_rank(b) > weight_rank(a) ? b : a;
+	}
+
+	struct face_key
+	{
+		// rotated to start at the smallest index, unused corners are ~0
+		std::array<std::uint32_t, 4> points;
+		std::uint64_t hash;
+		std::uint32_t face;
+		std::uint32_t distinct;
+	};
+
+	static face_key canonical(const mlod_face& face, const std::uint32_t index)
+	{
+		const auto n = face.corner_count();
+		std::uint32_t first = 0;
+
+		for (std::uint32_t c = 1; c < n; c++)
+		{
+			if (face.vertices[c].point_index < face.vertices[first].point_index)
+				first = c;
+		}
+
+		face_key key{};
+		key.points.fill(~std::uint32_t{ 0 });
+		key.face = index;
+
+		auto hash = std::uint64_t{ 0xcbf29ce484222325 };
+
+		for (std::uint32_t c = 0; c < n; c++)
+		{
+			const auto point = face.vertices[(first + c) % n].point_index;
+			key.points[c] = point;
+			hash = (hash ^ point) * 0x100000001b3;
+
+			auto seen = false;
+			for (std::uint32_t prev = 0; prev < c; prev++)
+				seen |= key.points[prev] == point;
+
+			key.distinct += seen ? 0 : 1;
+		}
+
+		key.hash = hash ^ (hash >> 29);
+		return key;
+	}
+
+	static face_cleanup_report run(mlod_lod& lod, const float min_area = 1e-9f)
+	{
+		face_cleanup_report report;
+
+		const auto num_faces = static_cast<std::uint32_t>(lod.faces.size());
+		const auto padded = (std::size_t{ num_faces } + 3) & ~std::size_t{ 3 };
+
+		aligned_vector<float> nx(padded), ny(padded), nz(padded);
+		std::vector<face_key> keys(num_faces);
+		std::vector<std::uint8_t> degenerate(num_faces);
+
+		parallel_for(num_faces, parallel_grain, [&](const std::size_t begin, const std::size_t end)
+		{
+			normal_generator::face_normals(lod, begin, end, nx.data(), ny.data(), nz.data());
+
+			for (auto f = begin; f < end; f++)
+			{
+				keys[f] = canonical(lod.faces[f], static_cast<std::uint32_t>(f));
+				degenerate[f] = keys[f].distinct < 3;
+			}
+		});
+
+		// face normals are twice the area long, compare squared lengths 4 faces at a time
+		const auto threshold = _mm_set1_ps(4.0f * min_area * min_area);
+
+		parallel_for(padded / 4, parallel_grain / 4, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto block = begin; block < end; block++)
+			{
+				const auto x = _mm_load_ps(nx.data() + block * 4);
+				const auto y = _mm_load_ps(ny.data() + block * 4);
+				const auto z = _mm_load_ps(nz.data() + block * 4);
+				const auto length_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+				const auto mask = _mm_movemask_ps(_mm_cmple_ps(length_sq, threshold));
+
+				for (std::uint32_t lane = 0; lane < 4; lane++)
+				{
+					const auto f = block * 4 + lane;
+
+					if (f < num_faces && (mask & (1 << lane)))
+						degenerate[f] = 1;
+				}
+			}
+		});
+
+		keys.erase(std::remove_if(keys.begin(), keys.end(), [&degenerate](const face_key& key) { return degenerate[key.face] != 0; }), keys.end());
+
+		parallel_sort(keys.begin(), keys.end(), [](const face_key& l, const face_key& r)
+		{
+			if (l.hash != r.hash)
+				return l.hash < r.hash;
+			if (l.points != r.points)
+				return l.points < r.points;
+			return l.face < r.face;
+		});
+
+		std::vector<std::uint32_t> survivor(num_faces, lod_remap::removed);
+
+		for (std::size_t run = 0, next = 0; run < keys.size(); run = next)
+		{
+			next = run + 1;
+			while (next < keys.size() && keys[next].hash == keys[run].hash && keys[next].points == keys[run].points)
+				next++;
+
+			for (auto i = run; i < next; i++)
+				survivor[keys[i].face] = keys[run].face;
+		}
+
+		const auto num_points = lod.points.size();
+
+		for (auto& tag : lod.tags)
+		{
+			if (!lod_remap::is_selection(tag) || tag.data.size() != num_points + num_faces)
+				continue;
+
+			for (std::uint32_t f = 0; f < num_faces; f++)
+			{
+				if (survivor[f] != lod_remap::removed && survivor[f] != f)
+				{
+					auto& weight = tag.data[num_points + survivor[f]];
+					weight = stronger_weight(weight, tag.data[num_points + f]);
+				}
+			}
+		}
+
+		std::vector<std::uint32_t> face_map(num_faces, lod_remap::removed);
+		std::uint32_t kept = 0;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			if (survivor[f] == lod_remap::removed)
+				report.degenerate++;
+			else if (survivor[f] != f)
+				report.duplicate++;
+			else
+				face_map[f] = kept++;
+		}
+
+		if (kept != num_faces)
+			lod_remap::remap_faces(lod, face_map, kept);
+
+		return report;
+	}
+
+	// every lod of a model, lods in parallel
+	static std::vector<face_cleanup_report> run(mlod_p3d& p3d, const float min_area = 1e-9f)
+	{
+		std::vector<face_cleanup_report> reports(p3d.lods.size());
+
+		parallel_for(p3d.lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				reports[i] = run(p3d.lods[i], min_area);
+		});
+
+		return reports;
+	}
+};
+
+// writes s as a quoted json string
+inline void append_json_string(std::string& out, const std::string_view s)
+{
+	out.push_back('"');
+
+	for (const auto c : s)
+	{
+		switch (c)
+		{
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\r': out += "\\r"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+				fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+			else
+				out.push_back(c);
+		}
+	}
+
+	out.push_back('"');
+}
+
+// binary gltf export, one node and mesh per lod. mlod is left handed with +z
+// forward, gltf is right handed with +z forward and -x right, so x is mirrored.
+// the mirror also turns clockwise mlod faces into gltf's counter clockwise ones,
+// the corner order is kept
+struct gltf_exporter
+{
+	static constexpr std::uint32_t glb_magic = 0x46546c67;
+	static constexpr std::uint32_t glb_version = 2;
+	static constexpr std::uint32_t json_chunk = 0x4e4f534a;
+	static constexpr std::uint32_t bin_chunk = 0x004e4942;
+
+	// a run of indices sharing one (texture, material) pair
+	struct primitive
+	{
+		std::uint32_t material;
+		std::uint32_t first_index;
+		std::uint32_t index_count;
+	};
+
+	// one lod triangulated and welded into gltf vertices
+	struct lod_mesh
+	{
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> uvs;
+		std::vector<std::uint32_t> indices;
+		std::vector<primitive> primitives;
+		// (texture, material) pairs primitive::material indexes, remapped to the file's list after building
+		std::vector<std::pair<std::string, std::string>> materials;
+		// gltf vertex -> mlod point
+		std::vector<std::uint32_t> vertex_points;
+		std::array<float, 3> min{};
+		std::array<float, 3> max{};
+		// min/max are written as json numbers, which have no inf or nan
+		bool finite{ true };
+	};
+
+	struct vertex_key
+	{
+		std::uint32_t point;
+		std::uint32_t normal;
+		std::uint32_t u;
+		std::uint32_t v;
+
+		bool operator==(const vertex_key& other) const
+		{
+			return point == other.point && normal == other.normal && u == other.u && v == other.v;
+		}
+	};
+
+	struct vertex_key_hash
+	{
+		std::size_t operator()(const vertex_key& key) const
+		{
+			auto hash = (std::uint64_t{ key.point } << 32 | key.normal) * 0x9e3779b97f4a7c15;
+			hash ^= (std::uint64_t{ key.u } << 32 | key.v) * 0xc2b2ae3d27d4eb4f;
+			return static_cast<std::size_t>(hash ^ (hash >> 31));
+		}
+	};
+
+	static lod_mesh build(const mlod_lod& lod)
+	{
+		lod_mesh mesh;
+
+		const auto num_points = lod.points.size();
+		const auto num_faces = static_cast<std::uint32_t>(lod.faces.size());
+
+		// faces bucketed by (texture, material), in order of first use
+		std::unordered_map<std::string, std::uint32_t> material_index;
+		std::vector<std::uint32_t> face_material(num_faces);
+		std::vector<std::uint32_t> bucket_size;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+		{
+			const auto& face = lod.faces[f];
+			const auto key = face.texture_name.string + '\n' + face.material_name.string;
+			const auto it = material_index.try_emplace(key, static_cast<std::uint32_t>(mesh.materials.size())).first;
+
+			if (it->second == mesh.materials.size())
+			{
+				mesh.materials.emplace_back(face.texture_name.string, face.material_name.string);
+				bucket_size.push_back(0);
+			}
+
+			face_material[f] = it->second;
+			bucket_size[it->second]++;
+		}
+
+		std::vector<std::uint32_t> bucket_start(bucket_size.size() + 1);
+		for (std::size_t m = 0; m < bucket_size.size(); m++)
+			bucket_start[m + 1] = bucket_start[m] + bucket_size[m];
+
+		std::vector<std::uint32_t> order(num_faces);
+		auto cursor = bucket_start;
+
+		for (std::uint32_t f = 0; f < num_faces; f++)
+			order[cursor[face_material[f]]++] = f;
+
+		std::unordered_map<vertex_key, std::uint32_t, vertex_key_hash> vertices;
+		vertices.reserve(num_points * 2);
+
+		mesh.min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		mesh.max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		const auto vertex = [&](const vert_descriptor& desc)
+		{
+			vertex_key key{ desc.point_index, desc.normal_index, 0, 0 };
+			std::memcpy(&key.u, &desc.u, sizeof(float));
+			std::memcpy(&key.v, &desc.v, sizeof(float));
+
+			const auto it = vertices.try_emplace(key, static_cast<std::uint32_t>(mesh.vertex_points.size())).first;
+
+			if (it->second != mesh.vertex_points.size())
+				return it->second;
+
+			const auto& pos = lod.points[desc.point_index].pos;
+			auto normal = desc.normal_index < lod.normals.size() ? lod.normals[desc.normal_index] : vector3{ 0.0f, 1.0f, 0.0f };
+			const float position[3] = { -pos.x, pos.y, pos.z };
+
+			// glTF requires unit normals, degenerate and non-finite ones point up
+			const auto length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+
+			if (length > 1e-15f && std::isfinite(length))
+				normal = { normal.x / length, normal.y / length, normal.z / length };
+			else
+				normal = { 0.0f, 1.0f, 0.0f };
+
+			for (auto axis = 0; axis < 3; axis++)
+			{
+				mesh.positions.push_back(position[axis]);
+				mesh.min[axis] = std::min(mesh.min[axis], position[axis]);
+				mesh.max[axis] = std::max(mesh.max[axis], position[axis]);
+				mesh.finite &= std::isfinite(position[axis]);
+			}
+
+			mesh.normals.insert(mesh.normals.end(), { -normal.x, normal.y, normal.z });
+			mesh.uvs.insert(mesh.uvs.end(), { desc.u, desc.v });
+			mesh.vertex_points.push_back(desc.point_index);
+
+			return it->second;
+		};
+
+		for (std::uint32_t m = 0; m < mesh.materials.size(); m++)
+		{
+			const auto first_index = static_cast<std::uint32_t>(mesh.indices.size());
+
+			for (auto i = bucket_start[m]; i < bucket_start[m + 1]; i++)
+			{
+				const auto& face = lod.faces[order[i]];
+				const auto n = face.corner_count();
+				auto valid = true;
+
+				for (std::uint32_t c = 0; c < n; c++)
+					valid &= face.vertices[c].point_index < num_points;
+
+				if (!valid)
+					continue;
+
+				for (std::uint32_t c = 1; c + 1 < n; c++)
+				{
+					mesh.indices.push_back(vertex(face.vertices[0]));
+					mesh.indices.push_back(vertex(face.vertices[c]));
+					mesh.indices.push_back(vertex(face.vertices[c + 1]));
+				}
+			}
+
+			const auto count = static_cast<std::uint32_t>(mesh.indices.size()) - first_index;
+
+			if (count != 0)
+				mesh.primitives.push_back({ m, first_index, count });
+		}
+
+		return mesh;
+	}
+
+	static std::string node_name(const mlod_lod& lod)
+	{
+		const auto* entry = find_lod_class(lod.resolution);
+		return fmt::format("{} {}", entry ? entry->name : "LOD", lod.resolution);
+	}
+
+	static std::optional<mlod_error> write(std::ostream& out, const mlod_p3d& p3d)
+	{
+		const auto num_lods = p3d.lods.size();
+		std::vector<lod_mesh> meshes(num_lods);
+
+		parallel_for(num_lods, 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				meshes[i] = build(p3d.lods[i]);
+		});
+
+		for (std::size_t i = 0; i < num_lods; i++)
+		{
+			if (!meshes[i].finite || !std::isfinite(p3d.lods[i].resolution))
+				return mlod_error(fmt::format("lod {} has non-finite coordinates or resolution, which gltf can't store", i));
+		}
+
+		// file wide material list
+		std::unordered_map<std::string, std::uint32_t> material_index;
+		std::vector<const std::pair<std::string, std::string>*> materials;
+
+		for (auto& mesh : meshes)
+		{
+			std::vector<std::uint32_t> remap(mesh.materials.size());
+
+			for (std::size_t m = 0; m < mesh.materials.size(); m++)
+			{
+				const auto& pair = mesh.materials[m];
+				const auto it = material_index.try_emplace(pair.first + '\n' + pair.second, static_cast<std::uint32_t>(materials.size())).first;
+
+				if (it->second == materials.size())
+					materials.push_back(&pair);
+
+				remap[m] = it->second;
+			}
+
+			for (auto& prim : mesh.primitives)
+				prim.material = remap[prim.material];
+		}
+
+		std::string json;
+		std::string nodes, mesh_list, accessors, views;
+		std::uint64_t bin_length = 0;
+		std::uint32_t accessor_count = 0, view_count = 0, mesh_count = 0;
+
+		const auto add_view = [&](const std::uint64_t length, const std::uint32_t target)
+		{
+			fmt::format_to(std::back_inserter(views), "{}{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":{}}}",
+				view_count ? "," : "", bin_length, length, target);
+			bin_length += length;
+			return view_count++;
+		};
+
+		for (std::size_t i = 0; i < num_lods; i++)
+		{
+			const auto& lod = p3d.lods[i];
+			const auto& mesh = meshes[i];
+
+			// the resolution goes on the node, the selections index the mesh's vertices
+			std::string selections = "{\"selections\":{";
+
+			auto first_selection = true;
+
+			for (const auto& tag : lod.tags)
+			{
+				if (!lod_remap::is_selection(tag) || tag.data.size() != lod.points.size() + lod.faces.size())
+					continue;
+
+				if (!first_selection)
+					selections.push_back(',');
+				first_selection = false;
+
+				append_json_string(selections, tag.tag_name.string);
+				selections += ":[";
+
+				auto first_vertex = true;
+
+				for (std::size_t v = 0; v < mesh.vertex_points.size(); v++)
+				{
+					if (tag.data[mesh.vertex_points[v]] == 0)
+						continue;
+
+					fmt::format_to(std::back_inserter(selections), "{}{}", first_vertex ? "" : ",", v);
+					first_vertex = false;
+				}
+
+				selections.push_back(']');
+			}
+
+			selections += "}}";
+
+			if (i != 0)
+				nodes.push_back(',');
+
+			nodes += "{\"name\":";
+			append_json_string(nodes, node_name(lod));
+
+			// gltf meshes need at least one primitive, faceless lods are bare nodes
+			if (!mesh.primitives.empty())
+			{
+				const auto vertex_count = mesh.vertex_points.size();
+				const auto position_view = add_view(vertex_count * 12, 34962);
+				const auto normal_view = add_view(vertex_count * 12, 34962);
+				const auto uv_view = add_view(vertex_count * 8, 34962);
+				const auto index_view = add_view(mesh.indices.size() * 4, 34963);
+
+				fmt::format_to(std::back_inserter(accessors),
+					"{}{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC3\",\"min\":[{},{},{}],\"max\":[{},{},{}]}},"
+					"{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC3\"}},"
+					"{{\"bufferView\":{},\"componentType\":5126,\"count\":{},\"type\":\"VEC2\"}}",
+					accessor_count ? "," : "", position_view, vertex_count, mesh.min[0], mesh.min[1], mesh.min[2], mesh.max[0], mesh.max[1], mesh.max[2],
+					normal_view, vertex_count, uv_view, vertex_count);
+
+				const auto position_accessor = accessor_count;
+				accessor_count += 3;
+
+				fmt::format_to(std::back_inserter(mesh_list), "{}{{\"primitives\":[", mesh_count ? "," : "");
+
+				for (std::size_t p = 0; p < mesh.primitives.size(); p++)
+				{
+					const auto& prim = mesh.primitives[p];
+
+					fmt::format_to(std::back_inserter(accessors), ",{{\"bufferView\":{},\"byteOffset\":{},\"componentType\":5125,\"count\":{},\"type\":\"SCALAR\"}}",
+						index_view, std::uint64_t{ prim.first_index } * 4, prim.index_count);
+
+					fmt::format_to(std::back_inserter(mesh_list), "{}{{\"attributes\":{{\"POSITION\":{},\"NORMAL\":{},\"TEXCOORD_0\":{}}},\"indices\":{},\"material\":{}}}",
+						p ? "," : "", position_accessor, position_accessor + 1, position_accessor + 2, accessor_count++, prim.material);
+				}
+
+				mesh_list += "],\"extras\":" + selections + "}";
+				fmt::format_to(std::back_inserter(nodes), ",\"mesh\":{}", mesh_count++);
+			}
+
+			fmt::format_to(std::back_inserter(nodes), ",\"extras\":{{\"resolution\":{}}}}}", lod.resolution);
+		}
+
+		json += "{\"asset\":{\"version\":\"2.0\",\"generator\":\"mlod-p3d\"},\"scene\":0,\"scenes\":[{\"nodes\":[";
+
+		for (std::size_t i = 0; i < num_lods; i++)
+			fmt::format_to(std::back_inserter(json), "{}{}", i ? "," : "", i);
+
+		json += "]}],\"nodes\":[" + nodes + "]";
+
+		if (mesh_count != 0)
+			json += ",\"meshes\":[" + mesh_list + "],\"accessors\":[" + accessors + "],\"bufferViews\":[" + views + "]";
+
+		if (bin_length != 0)
+			fmt::format_to(std::back_inserter(json), ",\"buffers\":[{{\"byteLength\":{}}}]", bin_length);
+
+		if (!materials.empty())
+		{
+			json += ",\"materials\":[";
+
+			for (std::size_t m = 0; m < materials.size(); m++)
+			{
+				const auto& pair = *materials[m];
+
+				json += m ? ",{\"name\":" : "{\"name\":";
+				append_json_string(json, pair.second.empty() ? pair.first : pair.second);
+				json += ",\"pbrMetallicRoughness\":{\"metallicFactor\":0,\"roughnessFactor\":1},\"extras\":{\"texture\":";
+				append_json_string(json, pair.first);
+				json += ",\"material\":";
+				append_json_string(json, pair.second);
+				json += "}}";
+			}
+
+			json.push_back(']');
+		}
+
+		json.push_back('}');
+
+		// chunks are 4 byte aligned, json pads with spaces
+		json.resize((json.size() + 3) & ~std::size_t{ 3 }, ' ');
+
+		const auto total = 12 + 8 + json.size() + (bin_length != 0 ? 8 + bin_length : 0);
+
+		if (total > std::numeric_limits<std::uint32_t>::max())
+			return mlod_error("glb output exceeds 4GB");
+
+		const auto write_u32 = [&out](const std::uint32_t value)
+		{
+			out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+
+		const auto write_array = [&out](const auto& values)
+		{
+			out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(values[0])));
+		};
+
+		write_u32(glb_magic);
+		write_u32(glb_version);
+		write_u32(static_cast<std::uint32_t>(total));
+		write_u32(static_cast<std::uint32_t>(json.size()));
+		write_u32(json_chunk);
+		out.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+		if (bin_length != 0)
+		{
+			write_u32(static_cast<std::uint32_t>(bin_length));
+			write_u32(bin_chunk);
+
+			// straight from each lod's arrays in buffer view order
+			for (const auto& mesh : meshes)
+			{
+				if (mesh.primitives.empty())
+					continue;
+
+				write_array(mesh.positions);
+				write_array(mesh.normals);
+				write_array(mesh.uvs);
+				write_array(mesh.indices);
+			}
+		}
+
+		if (!out)
+			return mlod_error("failed to write glb");
+
+		return {};
+	}
+
+	static std::optional<mlod_error> write(const std::string& path, const mlod_p3d& p3d)
+	{
+		std::ofstream out(path, std::ios::binary);
+
+		if (!out)
+			return mlod_error("failed to open " + path);
+
+		return write(out, p3d);
+	}
+};
+
+// wavefront obj export of a single lod. x is mirrored like the gltf export,
+// which keeps the corner order, and v is flipped to obj's bottom left origin.
+// points and normals keep their indices, every face corner gets its own vt.
+// usemtl carries the texture, defined in a companion .mtl, and g lists the
+// selections holding each face
+struct obj_exporter
+{
+	// elements formatted per task
+	static constexpr std::size_t chunk_size = 16384;
+	static constexpr const char* no_texture = "none";
+	static constexpr const char* no_group = "default";
+
+	// obj names end at whitespace and '#' starts a comment, so those and '%' itself
+	// are written as %xx. obj_importer::unescape_name reverses it
+	static std::string escape_name(const std::string_view name)
+	{
+		std::string out;
+		out.reserve(name.size());
+
+		for (const auto ch : name)
+		{
+			const auto byte = static_cast<unsigned char>(ch);
+
+			if (byte <= ' ' || byte == 0x7f || ch == '#' || ch == '%')
+				fmt::format_to(std::back_inserter(out), "%{:02x}", byte);
+			else
+				out.push_back(ch);
+		}
+
+		return out;
+	}
+
+	enum class section
+	{
+		points,
+		normals,
+		uvs,
+		faces,
+	};
+
+	struct task
+	{
+		section kind;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	// one material per texture in face order, the texture as its diffuse map
+	static std::optional<mlod_error> write_mtl(std::ostream& out, const mlod_lod& lod)
+	{
+		std::vector<const std::string*> textures;
+
+		for (const auto& face : lod.faces)
+		{
+			const auto& texture = face.texture_name.string;
+
+			if (std::none_of(textures.begin(), textures.end(), [&texture](const std::string* t) { return *t == texture; }))
+				textures.push_back(&texture);
+		}
+
+		fmt::memory_buffer buffer;
+		fmt::format_to(fmt::appender(buffer), "# mlod-p3d lod {}\n", lod.resolution);
+
+		for (const auto* texture : textures)
+		{
+			if (texture->empty())
+				fmt::format_to(fmt::appender(buffer), "\nnewmtl {}\nKd 1 1 1\n", no_texture);
+			else
+				fmt::format_to(fmt::appender(buffer), "\nnewmtl {}\nKd 1 1 1\nmap_Kd {}\n", escape_name(*texture), *texture);
+		}
+
+		out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+		if (!out)
+			return mlod_error("failed to write mtl");
+
+		return {};
+	}
+
+	// mtllib names the material library the usemtl lines refer to, none when empty
+	static std::optional<mlod_error> write(std::ostream& out, const mlod_lod& lod, const std::string_view mtllib = {})
+	{
+		const auto offsets = uv_set_tag::corner_offsets(lod.faces);
+		const auto num_points = lod.points.size();
+		const auto num_faces = lod.faces.size();
+
+		std::vector<const mlod_tag*> selections;
+		std::vector<std::string> group_names;
+
+		for (const auto& tag : lod.tags)
+		{
+			if (lod_remap::is_selection(tag) && tag.data.size() == num_points + num_faces)
+			{
+				selections.push_back(&tag);
+				group_names.push_back(escape_name(tag.tag_name.string));
+			}
+		}
+
+		std::vector<task> tasks;
+
+		const auto split = [&tasks](const section kind, const std::size_t count)
+		{
+			for (std::size_t begin = 0; begin < count; begin += chunk_size)
+				tasks.push_back({ kind, begin, std::min(begin + chunk_size, count) });
+		};
+
+		split(section::points, num_points);
+		split(section::normals, lod.normals.size());
+		split(section::uvs, num_faces);
+		split(section::faces, num_faces);
+
+		// the group a face starts, empty when it matches the face before it
+		const auto group_of = [&](const std::size_t f)
+		{
+			std::string group;
+
+			for (std::size_t s = 0; s < selections.size(); s++)
+			{
+				if (selections[s]->data[num_points + f] != 0)
+				{
+					group.push_back(' ');
+					group += group_names[s];
+				}
+			}
+
+			return group.empty() ? std::string(" ") + no_group : group;
+		};
+
+		std::vector<fmt::memory_buffer> buffers(tasks.size());
+
+		parallel_for(tasks.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto t = begin; t < end; t++)
+			{
+				const auto& job = tasks[t];
+				auto it = fmt::appender(buffers[t]);
+
+				switch (job.kind)
+				{
+				case section::points:
+					for (auto i = job.begin; i < job.end; i++)
+					{
+						const auto& pos = lod.points[i].pos;
+						it = fmt::format_to(it, "v {} {} {}\n", -pos.x, pos.y, pos.z);
+					}
+					break;
+
+				case section::normals:
+					for (auto i = job.begin; i < job.end; i++)
+					{
+						const auto& normal = lod.normals[i];
+						it = fmt::format_to(it, "vn {} {} {}\n", -normal.x, normal.y, normal.z);
+					}
+					break;
+
+				case section::uvs:
+					for (auto f = job.begin; f < job.end; f++)
+					{
+						const auto& face = lod.faces[f];
+
+						for (std::uint32_t c = 0; c < face.corner_count(); c++)
+							it = fmt::format_to(it, "vt {} {}\n", face.vertices[c].u, 1.0f - face.vertices[c].v);
+					}
+					break;
+
+				case section::faces:
+				{
+					auto texture = job.begin ? &lod.faces[job.begin - 1].texture_name.string : nullptr;
+					auto group = job.begin ? group_of(job.begin - 1) : std::string{};
+
+					for (auto f = job.begin; f < job.end; f++)
+					{
+						const auto& face = lod.faces[f];
+
+						if (!selections.empty() || f == 0)
+						{
+							auto face_group = group_of(f);
+
+							if (face_group != group)
+							{
+								it = fmt::format_to(it, "g{}\n", face_group);
+								group = std::move(face_group);
+							}
+						}
+
+						if (texture == nullptr || *texture != face.texture_name.string)
+						{
+							texture = &face.texture_name.string;
+							it = fmt::format_to(it, "usemtl {}\n", texture->empty() ? no_texture : escape_name(*texture));
+						}
+
+						*it++ = 'f';
+
+						for (std::uint32_t c = 0; c < face.corner_count(); c++)
+						{
+							const auto& desc = face.vertices[c];
+
+							if (desc.normal_index < lod.normals.size())
+								it = fmt::format_to(it, " {}/{}/{}", desc.point_index + std::uint64_t{ 1 }, offsets[f] + c + std::uint64_t{ 1 }, desc.normal_index + std::uint64_t{ 1 });
+							else
+								it = fmt::format_to(it, " {}/{}", desc.point_index + std::uint64_t{ 1 }, offsets[f] + c + std::uint64_t{ 1 });
+						}
+
+						*it++ = '\n';
+					}
+					break;
+				}
+				}
+			}
+		});
+
+		auto header = fmt::format("# mlod-p3d lod {}\n", lod.resolution);
+
+		if (!mtllib.empty())
+			header += fmt::format("mtllib {}\n", mtllib);
+
+		out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+		for (const auto& buffer : buffers)
+			out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+		if (!out)
+			return mlod_error("failed to write obj");
+
+		return {};
+	}
+
+	// writes the .mtl next to the obj, path with its extension replaced
+	static std::optional<mlod_error> write(const std::string& path, const mlod_lod& lod)
+	{
+		const auto name_start = path.find_last_of("/\\") + 1;
+		const auto dot = path.rfind('.');
+		const auto mtl_path = (dot != std::string::npos && dot > name_start ? path.substr(0, dot) : path) + ".mtl";
+
+		std::ofstream mtl(mtl_path, std::ios::binary);
+
+		if (!mtl)
+			return mlod_error("failed to open " + mtl_path);
+
+		if (auto err = write_mtl(mtl, lod))
+			return err;
+
+		std::ofstream out(path, std::ios::binary);
+
+		if (!out)
+			return mlod_error("failed to open " + path);
+
+		return write(out, lod, std::string_view(mtl_path).substr(name_start));
+	}
+};
+
+// wavefront obj import into a single lod, the inverse of obj_exporter: x is
+// mirrored back, v flipped, usemtl becomes texture_name and every g name a
+// named selection. the mapped file is split at line breaks and parsed in
+// parallel, faces with more than 4 corners are fanned into triangles and
+// corners without vn get generated normals
+struct obj_importer
+{
+	// bytes per parse task
+	static constexpr std::size_t min_chunk = 1 << 20;
+	static constexpr std::uint32_t inherit = ~std::uint32_t{ 0 };
+
+	// raw obj indices, 1 based or negative relative, 0 when missing
+	struct corner
+	{
+		std::int64_t point;
+		std::int64_t uv;
+		std::int64_t normal;
+	};
+
+	struct face_record
+	{
+		std::uint32_t first_corner;
+		std::uint32_t corner_count;
+		// chunk local, inherit until the chunk's first usemtl / g
+		std::uint32_t material;
+		std::uint32_t group;
+		// elements parsed so far in the chunk, negative indices count back from these
+		std::uint32_t points;
+		std::uint32_t uvs;
+		std::uint32_t normals;
+	};
+
+	struct chunk
+	{
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> uvs;
+		std::vector<corner> corners;
+		std::vector<face_record> faces;
+		std::vector<std::string> materials;
+		std::vector<std::vector<std::string>> groups;
+		// mlod faces after fanning
+		std::uint32_t output_faces{};
+		std::optional<mlod_error> error;
+	};
+
+	static const char* skip_spaces(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		return p;
+	}
+
+	static bool parse_float(const char*& p, const char* end, float& out)
+	{
+		p = skip_spaces(p, end);
+
+		if (p < end && *p == '+')
+			p++;
+
+		const auto result = std::from_chars(p, end, out);
+		p = result.ptr;
+		return result.ec == std::errc{};
+	}
+
+	static bool parse_index(const char*& p, const char* end, std::int64_t& out)
+	{
+		const auto result = std::from_chars(p, end, out);
+		p = result.ptr;
+		return result.ec == std::errc{};
+	}
+
+	static std::string_view next_word(const char*& p, const char* end)
+	{
+		p = skip_spaces(p, end);
+		const auto* start = p;
+
+		while (p < end && *p != ' ' && *p != '\t')
+			p++;
+
+		return { start, static_cast<std::size_t>(p - start) };
+	}
+
+	// decodes obj_exporter::escape_name's %xx, a % not followed by two hex digits is kept
+	static std::string unescape_name(const std::string_view name)
+	{
+		std::string out;
+		out.reserve(name.size());
+
+		for (std::size_t i = 0; i < name.size(); i++)
+		{
+			std::uint8_t byte{};
+
+			if (name[i] == '%' && i + 2 < name.size()
+				&& std::from_chars(name.data() + i + 1, name.data() + i + 3, byte, 16).ptr == name.data() + i + 3)
+			{
+				out.push_back(static_cast<char>(byte));
+				i += 2;
+			}
+			else
+				out.push_back(name[i]);
+		}
+
+		return out;
+	}
+
+	static void parse_chunk(const char* p, const char* end, chunk& out)
+	{
+		auto material = inherit, group = inherit;
+
+		while (p < end && !out.error)
+		{
+			const auto* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+			auto* line_end = newline ? newline : end;
+			const auto* next = newline ? newline + 1 : end;
+
+			if (const auto* comment = static_cast<const char*>(std::memchr(p, '#', static_cast<std::size_t>(line_end - p))))
+				line_end = comment;
+
+			while (line_end > p && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t'))
+				line_end--;
+
+			const auto keyword = next_word(p, line_end);
+
+			if (keyword == "v" || keyword == "vn")
+			{
+				auto& values = keyword == "v" ? out.positions : out.normals;
+				float x = 0.0f, y = 0.0f, z = 0.0f;
+
+				if (!parse_float(p, line_end, x) || !parse_float(p, line_end, y) || !parse_float(p, line_end, z))
+				{
+					out.error = mlod_error(fmt::format("malformed obj {} line", keyword));
+					break;
+				}
+
+				values.insert(values.end(), { x, y, z });
+			}
+			else if (keyword == "vt")
+			{
+				float u = 0.0f, v = 0.0f;
+
+				if (!parse_float(p, line_end, u))
+				{
+					out.error = mlod_error("malformed obj vt line");
+					break;
+				}
+
+				// v is optional
+				parse_float(p, line_end, v);
+				out.uvs.insert(out.uvs.end(), { u, v });
+			}
+			else if (keyword == "f")
+			{
+				face_record face{ static_cast<std::uint32_t>(out.corners.size()), 0, material, group,
+					static_cast<std::uint32_t>(out.positions.size() / 3),
+					static_cast<std::uint32_t>(out.uvs.size() / 2),
+					static_cast<std::uint32_t>(out.normals.size() / 3) };
+
+				for (p = skip_spaces(p, line_end); p < line_end; p = skip_spaces(p, line_end))
+				{
+					corner c{};
+
+					// v, v/vt, v//vn or v/vt/vn
+					auto valid = parse_index(p, line_end, c.point);
+
+					if (valid && p < line_end && *p == '/')
+					{
+						p++;
+
+						if (p < line_end && *p != '/')
+							valid = parse_index(p, line_end, c.uv);
+
+						if (valid && p < line_end && *p == '/')
+						{
+							p++;
+							valid = parse_index(p, line_end, c.normal);
+						}
+					}
+
+					if (!valid || c.point == 0)
+					{
+						out.error = mlod_error("malformed obj f line");
+						break;
+					}
+
+					out.corners.push_back(c);
+					face.corner_count++;
+				}
+
+				if (face.corner_count < 3)
+				{
+					out.corners.resize(face.first_corner);
+					p = next;
+					continue;
+				}
+
+				out.faces.push_back(face);
+				out.output_faces += face.corner_count <= 4 ? 1 : face.corner_count - 2;
+			}
+			else if (keyword == "usemtl")
+			{
+				const auto name = next_word(p, line_end);
+				material = static_cast<std::uint32_t>(out.materials.size());
+				out.materials.push_back(name == obj_exporter::no_texture ? std::string{} : unescape_name(name));
+			}
+			else if (keyword == "g")
+			{
+				std::vector<std::string> names;
+
+				for (auto name = next_word(p, line_end); !name.empty(); name = next_word(p, line_end))
+					names.push_back(unescape_name(name));
+
+				group = static_cast<std::uint32_t>(out.groups.size());
+				out.groups.push_back(std::move(names));
+			}
+
+			p = next;
+		}
+	}
+
+	static std::optional<mlod_error> parse(const char* data, const std::size_t size, mlod_lod& out, const float resolution = 1.0f)
+	{
+		out = mlod_lod::create(resolution);
+
+		// chunk bounds moved forward to the next line start
+		const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+		const auto count = std::max<std::size_t>(1, std::min(hw, size / min_chunk));
+		std::vector<std::size_t> bounds{ 0 };
+
+		for (std::size_t i = 1; i < count; i++)
+		{
+			auto pos = std::max(size * i / count, bounds.back());
+
+			while (pos < size && data[pos - 1] != '\n')
+				pos++;
+
+			bounds.push_back(pos);
+		}
+
+		bounds.push_back(size);
+
+		std::vector<chunk> chunks(count);
+
+		parallel_for(count, 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				parse_chunk(data + bounds[i], data + bounds[i + 1], chunks[i]);
+		});
+
+		// element offsets and the usemtl / g state each chunk starts with
+		std::vector<std::uint32_t> point_base(count + 1), uv_base(count + 1), normal_base(count + 1), face_base(count + 1);
+		std::vector<const std::string*> start_material(count);
+		std::vector<const std::vector<std::string>*> start_group(count);
+
+		static const std::string no_material;
+		static const std::vector<std::string> no_groups;
+		const auto* material = &no_material;
+		const auto* group = &no_groups;
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const auto& c = chunks[i];
+
+			if (c.error)
+				return c.error;
+
+			point_base[i + 1] = point_base[i] + static_cast<std::uint32_t>(c.positions.size() / 3);
+			uv_base[i + 1] = uv_base[i] + static_cast<std::uint32_t>(c.uvs.size() / 2);
+			normal_base[i + 1] = normal_base[i] + static_cast<std::uint32_t>(c.normals.size() / 3);
+			face_base[i + 1] = face_base[i] + c.output_faces;
+
+			start_material[i] = material;
+			start_group[i] = group;
+
+			if (!c.materials.empty())
+				material = &c.materials.back();
+			if (!c.groups.empty())
+				group = &c.groups.back();
+		}
+
+		// every group name gets a selection, "default" is what obj_exporter writes for none
+		std::unordered_map<std::string, std::uint32_t> selection_index;
+		std::vector<std::string> selection_names;
+		std::vector<std::vector<std::vector<std::uint32_t>>> chunk_groups(count);
+
+		const auto resolve_group = [&](const std::vector<std::string>& names)
+		{
+			std::vector<std::uint32_t> out_group;
+
+			for (const auto& name : names)
+			{
+				if (name == obj_exporter::no_group)
+					continue;
+
+				const auto it = selection_index.try_emplace(name, static_cast<std::uint32_t>(selection_names.size())).first;
+				if (it->second == selection_names.size())
+					selection_names.push_back(name);
+
+				out_group.push_back(it->second);
+			}
+
+			return out_group;
+		};
+
+		std::vector<std::vector<std::uint32_t>> start_selections(count);
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			start_selections[i] = resolve_group(*start_group[i]);
+
+			for (const auto& names : chunks[i].groups)
+				chunk_groups[i].push_back(resolve_group(names));
+		}
+
+		const auto num_points = point_base[count];
+		const auto num_uvs = uv_base[count];
+		const auto num_normals = normal_base[count];
+		const auto num_faces = face_base[count];
+
+		out.points.resize(num_points);
+		out.normals.resize(num_normals);
+		out.faces.resize(num_faces);
+
+		std::vector<std::vector<std::uint8_t>> selections(selection_names.size(), std::vector<std::uint8_t>(num_points + num_faces));
+		std::atomic<bool> missing_normals{ false }, bad_index{ false };
+
+		parallel_for(count, 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+			{
+				const auto& c = chunks[i];
+
+				for (std::size_t v = 0; v < c.positions.size() / 3; v++)
+					out.points[point_base[i] + v] = { { -c.positions[v * 3], c.positions[v * 3 + 1], c.positions[v * 3 + 2] }, 0 };
+
+				for (std::size_t v = 0; v < c.normals.size() / 3; v++)
+					out.normals[normal_base[i] + v] = { -c.normals[v * 3], c.normals[v * 3 + 1], c.normals[v * 3 + 2] };
+
+				const auto resolve = [](const std::int64_t raw, const std::uint32_t base, const std::uint32_t local, const std::uint32_t total)
+				{
+					const auto index = raw > 0 ? raw - 1 : std::int64_t{ base } + local + raw;
+					return index >= 0 && index < total ? static_cast<std::uint32_t>(index) : lod_remap::removed;
+				};
+
+				auto next_face = face_base[i];
+
+				for (const auto& record : c.faces)
+				{
+					const auto& texture = record.material == inherit ? *start_material[i] : c.materials[record.material];
+					const auto& face_selections = record.group == inherit ? start_selections[i] : chunk_groups[i][record.group];
+
+					std::array<vert_descriptor, 4> fan_corners{};
+					const auto descriptor = [&](const std::uint32_t k)
+					{
+						const auto& raw = c.corners[record.first_corner + k];
+						vert_descriptor desc{};
+
+						desc.point_index = resolve(raw.point, point_base[i], record.points, num_points);
+						desc.normal_index = raw.normal == 0 ? lod_remap::removed : resolve(raw.normal, normal_base[i], record.normals, num_normals);
+
+						if (desc.point_index == lod_remap::removed || (raw.normal != 0 && desc.normal_index == lod_remap::removed))
+							bad_index = true;
+
+						if (desc.normal_index == lod_remap::removed)
+							missing_normals = true;
+
+						const auto uv = raw.uv == 0 ? lod_remap::removed : resolve(raw.uv, uv_base[i], record.uvs, num_uvs);
+
+						if (uv != lod_remap::removed)
+						{
+							// uvs live in whichever chunk parsed them
+							const auto owner = static_cast<std::size_t>(std::upper_bound(uv_base.begin(), uv_base.end(), uv) - uv_base.begin() - 1);
+							const auto local = uv - uv_base[owner];
+							desc.u = chunks[owner].uvs[local * 2];
+							desc.v = 1.0f - chunks[owner].uvs[local * 2 + 1];
+						}
+
+						return desc;
+					};
+
+					const auto emit = [&](const std::uint32_t corners)
+					{
+						auto& face = out.faces[next_face];
+						face.face_type = corners;
+						face.vertices.assign(fan_corners.begin(), fan_corners.end());
+						face.texture_name.string = texture;
+
+						for (const auto selection : face_selections)
+							selections[selection][num_points + next_face] = 1;
+
+						next_face++;
+					};
+
+					if (record.corner_count <= 4)
+					{
+						for (std::uint32_t k = 0; k < record.corner_count; k++)
+							fan_corners[k] = descriptor(k);
+
+						emit(record.corner_count);
+						continue;
+					}
+
+					const auto first = descriptor(0);
+
+					for (std::uint32_t k = 1; k + 1 < record.corner_count; k++)
+					{
+						fan_corners = { first, descriptor(k), descriptor(k + 1), vert_descriptor{} };
+						emit(3);
+					}
+				}
+			}
+		});
+
+		if (bad_index)
+			return mlod_error("obj face references a missing element");
+
+		out.num_points = num_points;
+		out.num_faces = num_faces;
+		out.num_face_normals = num_normals;
+
+		for (std::size_t s = 0; s < selections.size(); s++)
+		{
+			auto& weights = selections[s];
+
+			for (std::uint32_t f = 0; f < num_faces; f++)
+			{
+				if (weights[num_points + f] == 0)
+					continue;
+
+				const auto& face = out.faces[f];
+				for (std::uint32_t c = 0; c < face.corner_count(); c++)
+					weights[face.vertices[c].point_index] = 1;
+			}
+
+			mlod_tag tag{};
+			tag.active = true;
+			tag.tag_name.string = selection_names[s];
+			tag.data = std::move(weights);
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+			out.add_tag(std::move(tag));
+		}
+
+		// only corners without a vn take a generated normal, the rest keep the imported one
+		if (missing_normals)
+		{
+			std::vector<std::uint32_t> imported_index(num_faces * std::size_t{ 4 });
+
+			for (std::size_t f = 0; f < num_faces; f++)
+			{
+				for (std::uint32_t c = 0; c < 4; c++)
+					imported_index[f * 4 + c] = out.faces[f].vertices[c].normal_index;
+			}
+
+			auto merged = out.normals;
+			normal_generator::run(out);
+
+			std::vector<std::uint32_t> generated_map(out.normals.size(), lod_remap::removed);
+
+			for (std::size_t f = 0; f < num_faces; f++)
+			{
+				auto& face = out.faces[f];
+
+				for (std::uint32_t c = 0; c < face.corner_count(); c++)
+				{
+					auto& desc = face.vertices[c];
+
+					if (imported_index[f * 4 + c] != lod_remap::removed)
+					{
+						desc.normal_index = imported_index[f * 4 + c];
+						continue;
+					}
+
+					auto& mapped = generated_map[desc.normal_index];
+
+					if (mapped == lod_remap::removed)
+					{
+						mapped = static_cast<std::uint32_t>(merged.size());
+						merged.push_back(out.normals[desc.normal_index]);
+					}
+
+					desc.normal_index = mapped;
+				}
+			}
+
+			out.normals = std::move(merged);
+			out.num_face_normals = static_cast<std::uint32_t>(out.normals.size());
+		}
+
+		return {};
+	}
+
+	static std::optional<mlod_error> parse(const std::string& path, mlod_lod& out, const float resolution = 1.0f)
+	{
+		const mapped_file file(path);
+
+		if (!file.opened)
+			return mlod_error("failed to open " + path);
+
+		return parse(file.data, file.size, out, resolution);
+	}
+};
+
+// just enough json for gltf
+struct json_value
+{
+	enum class kind : std::uint8_t
+	{
+		null,
+		boolean,
+		number,
+		string,
+		array,
+		object,
+	};
+
+	static constexpr int max_depth = 256;
+	static constexpr std::size_t none = ~std::size_t{ 0 };
+
+	kind type{ kind::null };
+	bool boolean{};
+	double number{};
+	std::string string;
+	std::vector<json_value> items;
+	std::vector<std::pair<std::string, json_value>> members;
+
+	const json_value* find(const std::string_view key) const
+	{
+		for (const auto& member : members)
+		{
+			if (member.first == key)
+				return &member.second;
+		}
+
+		return nullptr;
+	}
+
+	// nullptr when out of range or not an array
+	const json_value* at(const std::size_t index) const
+	{
+		return index < items.size() ? &items[index] : nullptr;
+	}
+
+	double number_or(const std::string_view key, const double fallback) const
+	{
+		const auto* value = find(key);
+		return value && value->type == kind::number ? value->number : fallback;
+	}
+
+	// non negative integer number, none otherwise
+	std::size_t as_index() const
+	{
+		if (type != kind::number || number < 0.0 || number >= 9007199254740992.0 || number != std::floor(number))
+			return none;
+
+		return static_cast<std::size_t>(number);
+	}
+
+	// fallback when key is missing, none when it isn't a valid index
+	std::size_t index_or(const std::string_view key, const std::size_t fallback = none) const
+	{
+		const auto* value = find(key);
+		return value ? value->as_index() : fallback;
+	}
+
+	std::string_view string_or(const std::string_view key, const std::string_view fallback = {}) const
+	{
+		const auto* value = find(key);
+		return value && value->type == kind::string ? std::string_view(value->string) : fallback;
+	}
+
+	static const char* skip_whitespace(const char* p, const char* end)
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+		return p;
+	}
+
+	static void append_utf8(std::string& out, const std::uint32_t code)
+	{
+		if (code < 0x80)
+			out.push_back(static_cast<char>(code));
+		else if (code < 0x800)
+		{
+			out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+			out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+		}
+		else if (code < 0x10000)
+		{
+			out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+			out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+			out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+		}
+		else
+		{
+			out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+			out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+			out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+			out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+		}
+	}
+
+	static bool parse_hex4(const char*& p, const char* end, std::uint32_t& out)
+	{
+		if (end - p < 4)
+			return false;
+
+		const auto result = std::from_chars(p, p + 4, out, 16);
+
+		if (result.ec != std::errc{} || result.ptr != p + 4)
+			return false;
+
+		p += 4;
+		return true;
+	}
+
+	static bool parse_string(const char*& p, const char* end, std::string& out)
+	{
+		// p is past the opening quote
+		while (p < end && *p != '"')
+		{
+			if (*p != '\\')
+			{
+				out.push_back(*p++);
+				continue;
+			}
+
+			if (++p >= end)
+				return false;
+
+			switch (*p++)
+			{
+			case '"': out.push_back('"'); break;
+			case '\\': out.push_back('\\'); break;
+			case '/': out.push_back('/'); break;
+			case 'b': out.push_back('\b'); break;
+			case 'f': out.push_back('\f'); break;
+			case 'n': out.push_back('\n'); break;
+			case 'r': out.push_back('\r'); break;
+			case 't': out.push_back('\t'); break;
+			case 'u':
+			{
+				std::uint32_t code;
+				if (!parse_hex4(p, end, code))
+					return false;
+
+				// a low surrogate alone is invalid
+				if (code >= 0xdc00 && code < 0xe000)
+					return false;
+
+				// a high surrogate must be followed by an escaped low surrogate
+				if (code >= 0xd800 && code < 0xdc00)
+				{
+					if (end - p < 6 || p[0] != '\\' || p[1] != 'u')
+						return false;
+
+					p += 2;
+					std::uint32_t low;
+					if (!parse_hex4(p, end, low) || low < 0xdc00 || low >= 0xe000)
+						return false;
+
+					code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+				}
+
+				append_utf8(out, code);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		if (p >= end)
+			return false;
+
+		p++;
+		return true;
+	}
+
+	static bool parse_value(const char*& p, const char* end, json_value& out, const int depth)
+	{
+		p = skip_whitespace(p, end);
+
+		if (p >= end || depth > max_depth)
+			return false;
+
+		const auto literal = [&p, end](const std::string_view word)
+		{
+			if (static_cast<std::size_t>(end - p) < word.size() || std::string_view(p, word.size()) != word)
+				return false;
+
+			p += word.size();
+			return true;
+		};
+
+		switch (*p)
+		{
+		case '{':
+		{
+			out.type = kind::object;
+			p = skip_whitespace(p + 1, end);
+
+			if (p < end && *p == '}')
+			{
+				p++;
+				return true;
+			}
+
+			while (p < end)
+			{
+				std::pair<std::string, json_value> member;
+
+				if (*p != '"' || !parse_string(++p, end, member.first))
+					return false;
+
+				p = skip_whitespace(p, end);
+
+				if (p >= end || *p++ != ':' || !parse_value(p, end, member.second, depth + 1))
+					return false;
+
+				out.members.push_back(std::move(member));
+				p = skip_whitespace(p, end);
+
+				if (p < end && *p == ',')
+				{
+					p = skip_whitespace(p + 1, end);
+					continue;
+				}
+
+				return p < end && *p++ == '}';
+			}
+
+			return false;
+		}
+		case '[':
+		{
+			out.type = kind::array;
+			p = skip_whitespace(p + 1, end);
+
+			if (p < end && *p == ']')
+			{
+				p++;
+				return true;
+			}
+
+			while (p < end)
+			{
+				out.items.emplace_back();
+
+				if (!parse_value(p, end, out.items.back(), depth + 1))
+					return false;
+
+				p = skip_whitespace(p, end);
+
+				if (p < end && *p == ',')
+				{
+					p++;
+					continue;
+				}
+
+				return p < end && *p++ == ']';
+			}
+
+			return false;
+		}
+		case '"':
+			out.type = kind::string;
+			return parse_string(++p, end, out.string);
+		case 't':
+			out.type = kind::boolean;
+			out.boolean = true;
+			return literal("true");
+		case 'f':
+			out.type = kind::boolean;
+			return literal("false");
+		case 'n':
+			return literal("null");
+		default:
+		{
+			out.type = kind::number;
+			const auto result = std::from_chars(p, end, out.number);
+			p = result.ptr;
+			return result.ec == std::errc{};
+		}
+		}
+	}
+
+	static std::optional<mlod_error> parse(const std::string_view text, json_value& out)
+	{
+		const auto* p = text.data();
+		const auto* end = text.data() + text.size();
+
+		if (!parse_value(p, end, out, 0) || skip_whitespace(p, end) != end)
+			return mlod_error(fmt::format("malformed json at offset {}", p - text.data()));
+
+		return {};
+	}
+};
+
+// gltf 2.0 (.gltf and .glb) import, the inverse of gltf_exporter: x is mirrored
+// back and corner order kept. buffers are read in place from the mapped file
+// (glb BIN chunk or external .bin), only data: uris are decoded. triangle
+// primitives of every node in the scene are placed with their world transform,
+// extras.resolution on a node or mesh picks the lod its subtree goes to, and
+// named nodes below that become named selections
+struct gltf_importer
+{
+	struct accessor_view
+	{
+		const std::uint8_t* data{};
+		std::size_t count{};
+		std::size_t stride{};
+		std::uint32_t component_type{};
+		std::uint32_t components{};
+		bool normalized{};
+
+		float component(const std::size_t i, const std::uint32_t c) const
+		{
+			const auto* element = data + i * stride;
+
+			switch (component_type)
+			{
+			case 5126:
+			{
+				float value;
+				std::memcpy(&value, element + c * 4, 4);
+				return value;
+			}
+			case 5120:
+			{
+				const auto value = static_cast<std::int8_t>(element[c]);
+				return normalized ? std::max(value / 127.0f, -1.0f) : value;
+			}
+			case 5121:
+				return normalized ? element[c] / 255.0f : element[c];
+			case 5122:
+			{
+				std::int16_t value;
+				std::memcpy(&value, element + c * 2, 2);
+				return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+			}
+			case 5123:
+			{
+				std::uint16_t value;
+				std::memcpy(&value, element + c * 2, 2);
+				return normalized ? value / 65535.0f : value;
+			}
+			default:
+				return 0.0f;
+			}
+		}
+
+		std::uint32_t index(const std::size_t i) const
+		{
+			const auto* element = data + i * stride;
+
+			switch (component_type)
+			{
+			case 5121:
+				return element[0];
+			case 5123:
+			{
+				std::uint16_t value;
+				std::memcpy(&value, element, 2);
+				return value;
+			}
+			default:
+			{
+				std::uint32_t value;
+				std::memcpy(&value, element, 4);
+				return value;
+			}
+			}
+		}
+	};
+
+	struct document
+	{
+		json_value json;
+		std::vector<std::unique_ptr<mapped_file>> files;
+		std::vector<std::vector<std::uint8_t>> decoded;
+		// pointer and size of every buffer
+		std::vector<std::pair<const std::uint8_t*, std::size_t>> buffers;
+	};
+
+	struct position_hash
+	{
+		std::size_t operator()(const std::array<std::uint32_t, 3>& key) const
+		{
+			const auto hash = (std::uint64_t{ key[0] } * 0x9e3779b97f4a7c15) ^ (std::uint64_t{ key[1] } * 0xc2b2ae3d27d4eb4f) ^ (std::uint64_t{ key[2] } * 0x165667b19e3779f9);
+			return static_cast<std::size_t>(hash ^ (hash >> 29));
+		}
+	};
+
+	// one lod being assembled
+	struct lod_builder
+	{
+		mlod_lod lod;
+		// points by the bits of their position
+		std::unordered_map<std::array<std::uint32_t, 3>, std::uint32_t, position_hash> point_index;
+		std::unordered_map<std::string, std::uint32_t> selection_index;
+		std::vector<std::string> selection_names;
+		// selection, face
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> selected_faces;
+		// selection, point
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> selected_points;
+		bool missing_normals{};
+	};
+
+	static std::vector<std::uint8_t> decode_base64(const std::string_view text)
+	{
+		std::vector<std::uint8_t> out;
+		out.reserve(text.size() * 3 / 4);
+
+		std::uint32_t bits = 0;
+		auto count = 0;
+
+		for (const auto c : text)
+		{
+			std::uint32_t value;
+
+			if (c >= 'A' && c <= 'Z')
+				value = static_cast<std::uint32_t>(c - 'A');
+			else if (c >= 'a' && c <= 'z')
+				value = static_cast<std::uint32_t>(c - 'a' + 26);
+			else if (c >= '0' && c <= '9')
+				value = static_cast<std::uint32_t>(c - '0' + 52);
+			else if (c == '+' || c == '-')
+				value = 62;
+			else if (c == '/' || c == '_')
+				value = 63;
+			else
+				continue;
+
+			bits = bits << 6 | value;
+			count += 6;
+
+			if (count >= 8)
+			{
+				count -= 8;
+				out.push_back(static_cast<std::uint8_t>(bits >> count));
+			}
+		}
+
+		return out;
+	}
+
+	static std::optional<mlod_error> load_buffers(document& doc, const std::string& base_dir, const std::uint8_t* bin, const std::size_t bin_size)
+	{
+		const auto* buffers = doc.json.find("buffers");
+
+		for (std::size_t i = 0; buffers && i < buffers->items.size(); i++)
+		{
+			const auto& buffer = buffers->items[i];
+			const auto length = buffer.index_or("byteLength", 0);
+			const auto uri = buffer.string_or("uri");
+
+			if (uri.empty())
+			{
+				// the glb BIN chunk
+				if (bin == nullptr || bin_size < length)
+					return mlod_error(fmt::format("gltf buffer {} has no data", i));
+
+				doc.buffers.emplace_back(bin, length);
+			}
+			else if (uri.substr(0, 5) == "data:")
+			{
+				const auto comma = uri.find(',');
+
+				if (comma == std::string_view::npos || uri.substr(0, comma).find(";base64") == std::string_view::npos)
+					return mlod_error(fmt::format("gltf buffer {} has an unsupported data uri", i));
+
+				doc.decoded.push_back(decode_base64(uri.substr(comma + 1)));
+
+				if (doc.decoded.back().size() < length)
+					return mlod_error(fmt::format("gltf buffer {} is truncated", i));
+
+				doc.buffers.emplace_back(doc.decoded.back().data(), length);
+			}
+			else
+			{
+				auto file = std::make_unique<mapped_file>(base_dir + std::string(uri));
+
+				if (!file->opened || file->size < length)
+					return mlod_error("failed to open gltf buffer " + std::string(uri));
+
+				doc.buffers.emplace_back(reinterpret_cast<const std::uint8_t*>(file->data), length);
+				doc.files.push_back(std::move(file));
+			}
+		}
+
+		return {};
+	}
+
+	static std::optional<mlod_error> view(const document& doc, const std::size_t index, accessor_view& out)
+	{
+		const auto* accessors = doc.json.find("accessors");
+		const auto* accessor = accessors ? accessors->at(index) : nullptr;
+
+		if (accessor == nullptr)
+			return mlod_error(fmt::format("gltf accessor {} is missing", index));
+
+		if (accessor->find("sparse"))
+			return mlod_error(fmt::format("gltf accessor {} is sparse, which isn't supported", index));
+
+		const auto type = accessor->string_or("type");
+		out.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+		out.component_type = static_cast<std::uint32_t>(accessor->number_or("componentType", 0.0));
+		out.count = accessor->index_or("count", 0);
+
+		const auto* normalized = accessor->find("normalized");
+		out.normalized = normalized && normalized->boolean;
+
+		const std::size_t component_size = out.component_type == 5126 || out.component_type == 5125 ? 4
+			: out.component_type == 5123 || out.component_type == 5122 ? 2
+			: out.component_type == 5121 || out.component_type == 5120 ? 1 : 0;
+
+		if (out.components == 0 || component_size == 0)
+			return mlod_error(fmt::format("gltf accessor {} has an unsupported layout", index));
+
+		const auto* views = doc.json.find("bufferViews");
+		const auto* buffer_view = views ? views->at(accessor->index_or("bufferView")) : nullptr;
+
+		if (buffer_view == nullptr)
+			return mlod_error(fmt::format("gltf accessor {} has no buffer view", index));
+
+		const auto buffer = buffer_view->index_or("buffer", 0);
+
+		if (buffer >= doc.buffers.size())
+			return mlod_error(fmt::format("gltf accessor {} points at a missing buffer", index));
+
+		const auto view_offset = buffer_view->index_or("byteOffset", 0);
+		const auto accessor_offset = accessor->index_or("byteOffset", 0);
+		const auto buffer_size = doc.buffers[buffer].second;
+		const auto element_size = component_size * out.components;
+
+		out.stride = buffer_view->index_or("byteStride", 0);
+		if (out.stride == 0)
+			out.stride = element_size;
+
+		// bounded first so the range check below can't overflow
+		if (view_offset > buffer_size || accessor_offset > buffer_size || out.count > buffer_size || out.stride > 255)
+			return mlod_error(fmt::format("gltf accessor {} runs past its buffer", index));
+
+		const auto offset = view_offset + accessor_offset;
+
+		if (out.count != 0 && offset + (out.count - 1) * out.stride + element_size > buffer_size)
+			return mlod_error(fmt::format("gltf accessor {} runs past its buffer", index));
+
+		out.data = doc.buffers[buffer].first + offset;
 		return {};
 	}
 
-	static void write(binary_writer& writer, const p3d_header& in)
+	static affine_transform node_transform(const json_value& node)
 	{
-		writer.write(in.signature);
-		writer.write(in.version);
-		writer.write(in.lod_count);
+		affine_transform out;
+
+		if (const auto* matrix = node.find("matrix"); matrix && matrix->items.size() == 16)
+		{
+			// column major, column vectors. rows here are its columns
+			for (std::size_t row = 0; row < 4; row++)
+			{
+				for (std::size_t col = 0; col < 3; col++)
+					out.m[row][col] = static_cast<float>(matrix->items[row * 4 + col].number);
+			}
+
+			return out;
+		}
+
+		const auto component = [&node](const char* key, const std::size_t i, const float fallback)
+		{
+			const auto* value = node.find(key);
+			return value && i < value->items.size() ? static_cast<float>(value->items[i].number) : fallback;
+		};
+
+		const auto x = component("rotation", 0, 0.0f), y = component("rotation", 1, 0.0f);
+		const auto z = component("rotation", 2, 0.0f), w = component("rotation", 3, 1.0f);
+
+		affine_transform rotation;
+		rotation.m[0] = { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w) };
+		rotation.m[1] = { 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) };
+		rotation.m[2] = { 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) };
+
+		return affine_transform::scale(component("scale", 0, 1.0f), component("scale", 1, 1.0f), component("scale", 2, 1.0f))
+			.then(rotation)
+			.then(affine_transform::translation(component("translation", 0, 0.0f), component("translation", 1, 0.0f), component("translation", 2, 0.0f)));
 	}
-};
 
-struct mlod_p3d
-{
-	p3d_header header;
-	std::vector<mlod_lod> lods;
+	static std::optional<float> resolution_of(const json_value* object)
+	{
+		const auto* extras = object ? object->find("extras") : nullptr;
+		const auto* resolution = extras ? extras->find("resolution") : nullptr;
 
-	static std::optional<mlod_error> parse(binary_reader& reader, mlod_p3d& out)
+		if (resolution && resolution->type == json_value::kind::number)
+			return static_cast<float>(resolution->number);
+
+		return {};
+	}
+
+	static std::uint32_t selection(lod_builder& builder, const std::string& name)
 	{
-		auto err = p3d_header::parse(reader, out.header);
+		const auto it = builder.selection_index.try_emplace(name, static_cast<std::uint32_t>(builder.selection_names.size())).first;
 
-		if (err.has_value())
-			return err;
+		if (it->second == builder.selection_names.size())
+			builder.selection_names.push_back(name);
 
-		out.lods.resize(out.header.lod_count);
+		return it->second;
+	}
 
-		for (auto& lod : out.lods)
+	static void face_names(const document& doc, const json_value& primitive, std::string& texture, std::string& material)
+	{
+		const auto* materials = doc.json.find("materials");
+		const auto* entry = materials ? materials->at(primitive.index_or("material")) : nullptr;
+
+		if (entry == nullptr)
+			return;
+
+		// gltf_exporter keeps the mlod names in extras
+		if (const auto* extras = entry->find("extras"); extras && extras->find("texture"))
 		{
-			err = mlod_lod::parse(reader, lod);
+			texture = extras->string_or("texture");
+			material = extras->string_or("material");
+			return;
+		}
 
-			if (err.has_value())
+		const auto* pbr = entry->find("pbrMetallicRoughness");
+		const auto* base_color = pbr ? pbr->find("baseColorTexture") : nullptr;
+		const auto* textures = doc.json.find("textures");
+		const auto* images = doc.json.find("images");
+		const auto* tex = base_color && textures ? textures->at(base_color->index_or("index")) : nullptr;
+		const auto* image = tex && images ? images->at(tex->index_or("source")) : nullptr;
+
+		if (image)
+			texture = image->string_or("uri", image->string_or("name"));
+	}
+
+	static std::optional<mlod_error> add_mesh(const document& doc, const json_value& mesh, const affine_transform& world,
+		const std::vector<std::string>& names, lod_builder& builder)
+	{
+		// gltf to mlod swaps handedness through the x mirror, a mirroring node
+		// transform on top of it flips the winding
+		const auto transform = world.then(affine_transform::scale(-1.0f, 1.0f, 1.0f));
+		const auto normal_matrix = transform.normal_matrix();
+		const auto reverse = world.determinant() < 0.0f;
+
+		std::vector<std::uint32_t> node_selections;
+		for (const auto& name : names)
+			node_selections.push_back(selection(builder, name));
+
+		const auto* primitives = mesh.find("primitives");
+		const auto* extras = mesh.find("extras");
+		const auto* mesh_selections = extras ? extras->find("selections") : nullptr;
+
+		for (std::size_t p = 0; primitives && p < primitives->items.size(); p++)
+		{
+			const auto& primitive = primitives->items[p];
+
+			// triangle lists only
+			if (primitive.number_or("mode", 4.0) != 4.0)
+				continue;
+
+			const auto* attributes = primitive.find("attributes");
+			const auto* position_accessor = attributes ? attributes->find("POSITION") : nullptr;
+
+			if (position_accessor == nullptr)
+				continue;
+
+			accessor_view positions, normals, uvs, indices;
+
+			if (auto err = view(doc, position_accessor->as_index(), positions))
 				return err;
+
+			if (positions.component_type != 5126 || positions.components != 3)
+				return mlod_error("gltf POSITION has to be float VEC3");
+
+			const auto* normal_accessor = attributes->find("NORMAL");
+			const auto* uv_accessor = attributes->find("TEXCOORD_0");
+
+			if (normal_accessor)
+			{
+				if (auto err = view(doc, normal_accessor->as_index(), normals))
+					return err;
+			}
+
+			if (uv_accessor)
+			{
+				if (auto err = view(doc, uv_accessor->as_index(), uvs))
+					return err;
+			}
+
+			if (const auto* index_accessor = primitive.find("indices"))
+			{
+				if (auto err = view(doc, index_accessor->as_index(), indices))
+					return err;
+
+				// index() only reads the unsigned types the spec allows
+				if (indices.component_type != 5121 && indices.component_type != 5123 && indices.component_type != 5125)
+					return mlod_error("gltf primitive indices must be unsigned integers");
+			}
+
+			auto& lod = builder.lod;
+			const auto normal_base = static_cast<std::uint32_t>(lod.normals.size());
+			std::vector<std::uint32_t> vertex_point(positions.count);
+
+			for (std::size_t v = 0; v < positions.count; v++)
+			{
+				const vector3 pos{ positions.component(v, 0), positions.component(v, 1), positions.component(v, 2) };
+				const auto& m = transform.m;
+
+				const vector3 moved{
+					pos.x * m[0][0] + pos.y * m[1][0] + pos.z * m[2][0] + m[3][0],
+					pos.x * m[0][1] + pos.y * m[1][1] + pos.z * m[2][1] + m[3][1],
+					pos.x * m[0][2] + pos.y * m[1][2] + pos.z * m[2][2] + m[3][2] };
+
+				// points are shared by exact position, gltf splits them at every seam
+				std::array<std::uint32_t, 3> key;
+				std::memcpy(key.data(), &moved, sizeof(key));
+
+				const auto it = builder.point_index.try_emplace(key, static_cast<std::uint32_t>(lod.points.size())).first;
+
+				if (it->second == lod.points.size())
+					lod.points.push_back({ moved, 0 });
+
+				vertex_point[v] = it->second;
+
+				for (const auto s : node_selections)
+					builder.selected_points.emplace_back(s, it->second);
+			}
+
+			if (normal_accessor && normals.count == positions.count)
+			{
+				const auto& m = normal_matrix.m;
+
+				for (std::size_t v = 0; v < normals.count; v++)
+				{
+					const auto x = normals.component(v, 0), y = normals.component(v, 1), z = normals.component(v, 2);
+					vector3 n{ x * m[0][0] + y * m[1][0] + z * m[2][0], x * m[0][1] + y * m[1][1] + z * m[2][1], x * m[0][2] + y * m[1][2] + z * m[2][2] };
+					const auto length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+					if (length > 0.0f)
+						n = { n.x / length, n.y / length, n.z / length };
+
+					lod.normals.push_back(n);
+				}
+			}
+			else
+				builder.missing_normals = true;
+
+			// gltf_exporter's per mesh selections, as vertex indices
+			for (std::size_t s = 0; mesh_selections && s < mesh_selections->members.size(); s++)
+			{
+				const auto index = selection(builder, mesh_selections->members[s].first);
+
+				for (const auto& item : mesh_selections->members[s].second.items)
+				{
+					const auto v = item.as_index();
+
+					if (v < vertex_point.size())
+						builder.selected_points.emplace_back(index, vertex_point[v]);
+				}
+			}
+
+			std::string texture, material;
+			face_names(doc, primitive, texture, material);
+
+			const auto corner_count = indices.data ? indices.count : positions.count;
+			const auto has_normals = normal_accessor && normals.count == positions.count;
+
+			for (std::size_t t = 0; t + 3 <= corner_count; t += 3)
+			{
+				mlod_face face{};
+				face.face_type = 3;
+				face.vertices.resize(4);
+				face.texture_name.string = texture;
+				face.material_name.string = material;
+
+				auto valid = true;
+
+				for (std::uint32_t c = 0; c < 3; c++)
+				{
+					const auto v = indices.data ? indices.index(t + c) : static_cast<std::uint32_t>(t + c);
+
+					if (v >= positions.count)
+					{
+						valid = false;
+						break;
+					}
+
+					auto& desc = face.vertices[reverse ? 2 - c : c];
+					desc.point_index = vertex_point[v];
+					desc.normal_index = has_normals ? normal_base + v : lod_remap::removed;
+
+					if (uv_accessor && v < uvs.count)
+					{
+						desc.u = uvs.component(v, 0);
+						desc.v = uvs.component(v, 1);
+					}
+				}
+
+				if (!valid)
+					return mlod_error("gltf index points past its vertices");
+
+				for (const auto s : node_selections)
+					builder.selected_faces.emplace_back(s, static_cast<std::uint32_t>(lod.faces.size()));
+
+				lod.faces.push_back(std::move(face));
+			}
 		}
-		return { };
+
+		return {};
 	}
 
-	static void write(binary_writer& writer, const mlod_p3d& in)
+	static std::optional<mlod_error> add_node(const document& doc, const std::size_t index, const affine_transform& parent, float resolution,
+		std::vector<std::string> names, std::vector<lod_builder>& builders, std::vector<std::uint8_t>& visiting)
 	{
-		p3d_header::write(writer, in.header);
+		const auto* nodes = doc.json.find("nodes");
+		const auto* node = nodes ? nodes->at(index) : nullptr;
 
-		for (const auto& lod : in.lods)
+		if (node == nullptr || visiting[index])
+			return mlod_error(fmt::format("gltf node {} is missing or part of a cycle", index));
+
+		visiting[index] = 1;
+
+		const auto world = node_transform(*node).then(parent);
+		const auto* meshes = doc.json.find("meshes");
+		const auto* mesh = meshes ? meshes->at(node->index_or("mesh")) : nullptr;
+
+		// lod nodes pick the resolution, other named nodes become selections
+		const auto node_resolution = resolution_of(node);
+		const auto mesh_resolution = resolution_of(mesh);
+
+		if (node_resolution || mesh_resolution)
+			resolution = node_resolution ? *node_resolution : *mesh_resolution;
+		else if (const auto name = node->string_or("name"); !name.empty())
+			names.emplace_back(name);
+
+		// lod nodes without a mesh still make their (empty) lod
+		if (mesh || node_resolution)
 		{
-			mlod_lod::write(writer, lod);
+			auto builder = std::find_if(builders.begin(), builders.end(), [resolution](const lod_builder& b) { return b.lod.resolution == resolution; });
+
+			if (builder == builders.end())
+			{
+				builders.emplace_back();
+				builders.back().lod = mlod_lod::create(resolution);
+				builder = builders.end() - 1;
+			}
+
+			if (mesh)
+			{
+				if (auto err = add_mesh(doc, *mesh, world, names, *builder))
+					return err;
+			}
+		}
+
+		if (const auto* children = node->find("children"))
+		{
+			for (const auto& child : children->items)
+			{
+				if (auto err = add_node(doc, child.as_index(), world, resolution, names, builders, visiting))
+					return err;
+			}
+		}
+
+		visiting[index] = 0;
+		return {};
+	}
+
+	static void finish(lod_builder& builder)
+	{
+		auto& lod = builder.lod;
+		const auto num_points = lod.points.size();
+		const auto num_faces = lod.faces.size();
+
+		lod.num_points = static_cast<std::uint32_t>(num_points);
+		lod.num_faces = static_cast<std::uint32_t>(num_faces);
+		lod.num_face_normals = static_cast<std::uint32_t>(lod.normals.size());
+
+		std::vector<std::vector<std::uint8_t>> selections(builder.selection_names.size(), std::vector<std::uint8_t>(num_points + num_faces));
+
+		for (const auto& [s, point] : builder.selected_points)
+			selections[s][point] = 1;
+
+		for (const auto& [s, face] : builder.selected_faces)
+			selections[s][num_points + face] = 1;
+
+		// selections given as points also hold the faces they cover
+		for (auto& data : selections)
+		{
+			for (std::size_t f = 0; f < num_faces; f++)
+			{
+				const auto& v = lod.faces[f].vertices;
+
+				if (data[v[0].point_index] && data[v[1].point_index] && data[v[2].point_index])
+					data[num_points + f] = 1;
+			}
+		}
+
+		for (std::size_t s = 0; s < selections.size(); s++)
+		{
+			mlod_tag tag{};
+			tag.active = true;
+			tag.tag_name.string = builder.selection_names[s];
+			tag.data = std::move(selections[s]);
+			tag.data_length = static_cast<std::uint32_t>(tag.data.size());
+			lod.add_tag(std::move(tag));
+		}
+
+		if (builder.missing_normals)
+			normal_generator::run(lod);
+		else
+			normal_dedup::run(lod);
+	}
+
+	// base_dir is prepended to external buffer uris
+	static std::optional<mlod_error> parse(const std::uint8_t* data, const std::size_t size, const std::string& base_dir, mlod_p3d& out)
+	{
+		document doc;
+		std::string_view text(reinterpret_cast<const char*>(data), size);
+		const std::uint8_t* bin = nullptr;
+		std::size_t bin_size = 0;
+
+		if (size >= 4 && std::memcmp(data, "glTF", 4) == 0)
+		{
+			// 12 byte header, then JSON and BIN chunks each led by length and type
+			if (size < 20)
+				return mlod_error("malformed glb header");
+
+			std::uint32_t json_length, json_type;
+			std::memcpy(&json_length, data + 12, 4);
+			std::memcpy(&json_type, data + 16, 4);
+
+			if (json_type != gltf_exporter::json_chunk || 20 + std::size_t{ json_length } > size)
+				return mlod_error("malformed glb header");
+
+			text = { reinterpret_cast<const char*>(data + 20), json_length };
+
+			const auto bin_offset = 20 + std::size_t{ json_length };
+
+			if (bin_offset + 8 <= size)
+			{
+				std::uint32_t bin_length, bin_type;
+				std::memcpy(&bin_length, data + bin_offset, 4);
+				std::memcpy(&bin_type, data + bin_offset + 4, 4);
+
+				if (bin_type == gltf_exporter::bin_chunk && bin_offset + 8 + bin_length <= size)
+				{
+					bin = data + bin_offset + 8;
+					bin_size = bin_length;
+				}
+			}
+		}
+
+		if (auto err = json_value::parse(text, doc.json))
+			return err;
+
+		if (auto err = load_buffers(doc, base_dir, bin, bin_size))
+			return err;
+
+		const auto* nodes = doc.json.find("nodes");
+		const auto node_count = nodes ? nodes->items.size() : 0;
+		std::vector<std::size_t> roots;
+
+		const auto* scenes = doc.json.find("scenes");
+		const auto* scene = scenes ? scenes->at(doc.json.index_or("scene", 0)) : nullptr;
+
+		if (const auto* scene_nodes = scene ? scene->find("nodes") : nullptr)
+		{
+			for (const auto& node : scene_nodes->items)
+				roots.push_back(node.as_index());
+		}
+		else
+		{
+			// no scene, every node nobody lists as a child
+			std::vector<std::uint8_t> is_child(node_count);
+
+			for (std::size_t i = 0; i < node_count; i++)
+			{
+				if (const auto* children = nodes->items[i].find("children"))
+				{
+					for (const auto& child : children->items)
+					{
+						if (child.as_index() < node_count)
+							is_child[child.as_index()] = 1;
+					}
+				}
+			}
+
+			for (std::size_t i = 0; i < node_count; i++)
+			{
+				if (!is_child[i])
+					roots.push_back(i);
+			}
+		}
+
+		std::vector<lod_builder> builders;
+		std::vector<std::uint8_t> visiting(node_count);
+
+		for (const auto root : roots)
+		{
+			if (auto err = add_node(doc, root, affine_transform{}, 1.0f, {}, builders, visiting))
+				return err;
 		}
+
+		parallel_for(builders.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				finish(builders[i]);
+		});
+
+		out = mlod_p3d::create();
+
+		for (auto& builder : builders)
+			out.lods.push_back(std::move(builder.lod));
+
+		std::stable_sort(out.lods.begin(), out.lods.end(), [](const mlod_lod& l, const mlod_lod& r)
+		{
+			return l.resolution < r.resolution;
+		});
+
+		out.header.lod_count = static_cast<std::uint32_t>(out.lods.size());
+		out.rebuild_lod_map();
+
+		return {};
+	}
+
+	static std::optional<mlod_error> parse(const std::string& path, mlod_p3d& out)
+	{
+		const mapped_file file(path);
+
+		if (!file.opened)
+			return mlod_error("failed to open " + path);
+
+		const auto slash = path.find_last_of("/\\");
+		const auto base_dir = slash == std::string::npos ? std::string{} : path.substr(0, slash + 1);
+
+		return parse(reinterpret_cast<const std::uint8_t*>(file.data), file.size, base_dir, out);
 	}
 };
 
-#pragma pack(pop)
+// binary little endian ply. mlod_point's packed x, y, z, flags layout is the
+// vertex element, so without #Mass# points go out as one block. with it mass
+// is interleaved through a small staging buffer. faces are uchar counted uint
+// lists, staged the same way
+struct ply_writer
+{
+	static_assert(sizeof(mlod_point) == 16, "mlod_point has to match the ply vertex layout");
+
+	// elements staged per write
+	static constexpr std::size_t chunk_size = 4096;
+
+	static std::optional<mlod_error> write(std::ostream& out, const mlod_lod& lod)
+	{
+		const auto num_points = lod.points.size();
+		const auto& mass = lod.mass->mass;
+		const auto has_mass = !mass.empty() && mass.size() == num_points;
+
+		std::string header = "ply\nformat binary_little_endian 1.0\ncomment mlod-p3d\n";
+		fmt::format_to(std::back_inserter(header), "comment resolution {}\nelement vertex {}\n", lod.resolution, num_points);
+		header += "property float x\nproperty float y\nproperty float z\nproperty uint flags\n";
+
+		if (has_mass)
+			header += "property float mass\n";
+
+		fmt::format_to(std::back_inserter(header), "element face {}\nproperty list uchar uint vertex_indices\nend_header\n", lod.faces.size());
+		out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+		std::vector<char> staging;
+
+		if (!has_mass)
+			out.write(reinterpret_cast<const char*>(lod.points.data()), static_cast<std::streamsize>(num_points * sizeof(mlod_point)));
+		else
+		{
+			constexpr auto record = sizeof(mlod_point) + sizeof(float);
+			staging.resize(chunk_size * record);
+
+			for (std::size_t begin = 0; begin < num_points; begin += chunk_size)
+			{
+				const auto end = std::min(begin + chunk_size, num_points);
+				auto* cursor = staging.data();
+
+				for (auto i = begin; i < end; i++, cursor += record)
+				{
+					std::memcpy(cursor, &lod.points[i], sizeof(mlod_point));
+					std::memcpy(cursor + sizeof(mlod_point), &mass[i], sizeof(float));
+				}
+
+				out.write(staging.data(), cursor - staging.data());
+			}
+		}
+
+		constexpr auto max_record = 1 + 4 * sizeof(std::uint32_t);
+		staging.resize(chunk_size * max_record);
+
+		for (std::size_t begin = 0; begin < lod.faces.size(); begin += chunk_size)
+		{
+			const auto end = std::min(begin + chunk_size, lod.faces.size());
+			auto* cursor = staging.data();
+
+			for (auto f = begin; f < end; f++)
+			{
+				const auto& face = lod.faces[f];
+				const auto n = face.corner_count();
+
+				*cursor++ = static_cast<char>(n);
+
+				for (std::uint32_t c = 0; c < n; c++, cursor += sizeof(std::uint32_t))
+					std::memcpy(cursor, &face.vertices[c].point_index, sizeof(std::uint32_t));
+			}
+
+			out.write(staging.data(), cursor - staging.data());
+		}
+
+		if (!out)
+			return mlod_error("failed to write ply");
+
+		return {};
+	}
+
+	static std::optional<mlod_error> write(const std::string& path, const mlod_lod& lod)
+	{
+		std::ofstream out(path, std::ios::binary);
+
+		if (!out)
+			return mlod_error("failed to open " + path);
+
+		return write(out, lod);
+	}
+
+	// every lod to <prefix>_<lod index>.ply, lods in parallel. one result per lod
+	static std::vector<std::optional<mlod_error>> write(const std::string& prefix, const mlod_p3d& p3d)
+	{
+		std::vector<std::optional<mlod_error>> results(p3d.lods.size());
+
+		parallel_for(p3d.lods.size(), 1, [&](const std::size_t begin, const std::size_t end)
+		{
+			for (auto i = begin; i < end; i++)
+				results[i] = write(fmt::format("{}_{}.ply", prefix, i), p3d.lods[i]);
+		});
+
+		return results;
+	}
+};
 
 int main()
 {